@@ -0,0 +1,56 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+#ifndef BENCH_BENCH_H_
+#define BENCH_BENCH_H_
+
+#include "uv.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+namespace bench {
+
+// Calls fn until at least min_ns have passed and returns the mean time of
+// one call in nanoseconds. One untimed call warms caches and allocators.
+template <typename Fn>
+double TimePerCall(Fn fn, uint64_t min_ns = 200 * 1000 * 1000) {
+  fn();
+  uint64_t calls = 0;
+  uint64_t start = uv_hrtime();
+  uint64_t elapsed;
+  do {
+    fn();
+    calls++;
+    elapsed = uv_hrtime() - start;
+  } while (elapsed < min_ns);
+  return static_cast<double>(elapsed) / calls;
+}
+
+inline double GBPerSecond(size_t bytes, double ns) {
+  return bytes / ns;
+}
+
+}  // namespace bench
+
+#endif  // BENCH_BENCH_H_
@@ -0,0 +1,106 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+// Round trip latency of a WebSocket message through the server over loopback
+// TCP and over a Unix domain socket (InspectorOptions::unix_socket_path).
+// The client sends a message and waits for its echo before sending the next.
+
+#include "bench.h"
+#include "echo_server.h"
+#include "ws_client.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int kWarmupRoundTrips = 1000;
+const int kRoundTrips = 20000;
+
+bool Measure(bench::WsClient* client, size_t message_size,
+             std::vector<uint64_t>* samples) {
+  std::string message(message_size, 'x');
+  std::string response;
+  uint8_t first_byte;
+  samples->clear();
+  for (int i = 0; i < kWarmupRoundTrips + kRoundTrips; i++) {
+    uint64_t start = uv_hrtime();
+    if (!client->SendFrame(message) ||
+        !client->ReadFrame(&first_byte, &response) ||
+        response.size() != message_size) {
+      return false;
+    }
+    if (i >= kWarmupRoundTrips)
+      samples->push_back(uv_hrtime() - start);
+  }
+  std::sort(samples->begin(), samples->end());
+  return true;
+}
+
+bool Run(const char* label, const std::string& unix_socket_path) {
+  inspector::InspectorOptions options;
+  options.unix_socket_path = unix_socket_path;
+  options.ping_interval_ms = 0;
+  bench::EchoServer server(options);
+  if (!server.Start()) {
+    fprintf(stderr, "%s: server did not start\n", label);
+    return false;
+  }
+  bool ok;
+  {
+    bench::WsClient client;
+    std::string response;
+    ok = (unix_socket_path.empty() ? client.ConnectTcp(server.port())
+                                   : client.ConnectUnix(unix_socket_path)) &&
+         client.Handshake("bench", "", &response);
+    const size_t kSizes[] = {128, 4096, 65536};
+    std::vector<uint64_t> samples;
+    for (size_t size : kSizes) {
+      if (!ok)
+        break;
+      ok = Measure(&client, size, &samples);
+      if (ok) {
+        printf("%-4s %6zu B  median %7.1f us  p99 %7.1f us\n", label, size,
+               samples[samples.size() / 2] / 1000.0,
+               samples[samples.size() * 99 / 100] / 1000.0);
+      }
+    }
+  }
+  if (!ok)
+    fprintf(stderr, "%s: echo failed\n", label);
+  server.Stop();
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  std::string path = "/tmp/v8inspector-bench-" + std::to_string(getpid());
+  unlink(path.c_str());
+  bool ok = Run("tcp", "") && Run("uds", path);
+  unlink(path.c_str());
+  return ok ? 0 : 1;
+}
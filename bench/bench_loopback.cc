@@ -0,0 +1,105 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+// Messages through LoopbackTransport and an echoing delegate, i.e. the
+// cross-thread handoff to the IO thread and back without any socket. This is
+// the baseline the socket numbers of bench_latency compare against, and
+// runs the same everywhere, so it suits CI.
+
+#include "bench.h"
+#include "echo_server.h"
+#include "inspector_loopback.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+typedef bench::EchoTransport<inspector::LoopbackTransport> LoopbackEcho;
+typedef std::vector<std::pair<int, std::string>> SentMessages;
+
+const int kBurst = 100000;
+const int kRoundTrips = 20000;
+const unsigned int kTimeoutMs = 10000;
+
+std::string Message(int id) {
+  return "{\"id\":" + std::to_string(id) +
+         ",\"method\":\"Runtime.evaluate\",\"params\":{\"expression\":\"1\"}}";
+}
+
+// Injects a burst of messages and waits for all echoes.
+bool Burst(inspector::LoopbackTransport* transport, int session_id) {
+  SentMessages sent;
+  uint64_t start = uv_hrtime();
+  for (int i = 0; i < kBurst; i++)
+    transport->Inject(session_id, Message(i));
+  if (!transport->TakeSent(kBurst, kTimeoutMs, &sent))
+    return false;
+  uint64_t elapsed = uv_hrtime() - start;
+  for (int i = 0; i < kBurst; i++) {
+    if (sent[i].second != Message(i))
+      return false;
+  }
+  printf("loopback burst of %d  %7.1f ns/message\n", kBurst,
+         static_cast<double>(elapsed) / kBurst);
+  return true;
+}
+
+// One message at a time, each waiting for its echo.
+bool RoundTrips(inspector::LoopbackTransport* transport, int session_id) {
+  SentMessages sent;
+  std::vector<uint64_t> samples;
+  for (int i = 0; i < kRoundTrips; i++) {
+    uint64_t start = uv_hrtime();
+    transport->Inject(session_id, Message(i));
+    if (!transport->TakeSent(1, kTimeoutMs, &sent))
+      return false;
+    samples.push_back(uv_hrtime() - start);
+    sent.clear();
+  }
+  std::sort(samples.begin(), samples.end());
+  printf("loopback round trip  median %7.1f us  p99 %7.1f us\n",
+         samples[samples.size() / 2] / 1000.0,
+         samples[samples.size() * 99 / 100] / 1000.0);
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  inspector::InspectorOptions options;
+  LoopbackEcho echo(options);
+  if (!echo.Start()) {
+    fprintf(stderr, "loopback transport did not start\n");
+    return 1;
+  }
+  inspector::LoopbackTransport* transport = echo.transport();
+  int session_id = transport->Connect("bench");
+  bool ok = Burst(transport, session_id) && RoundTrips(transport, session_id);
+  if (!ok)
+    fprintf(stderr, "echo failed\n");
+  transport->Disconnect(session_id);
+  echo.Stop();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+// Contention on the InspectorIo message queues under a console flood: a
+// number of threads post console notifications as fast as they can while one
+// consumer drains them, as the IO thread drains outgoing_message_queue_.
+// AtomicQueue is compared with the mutex and swapped deque it replaced.
+
+#include "inspector_queue.h"
+#include "uv.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kMessagesPerProducer = 200000;
+const int kRuns = 5;
+const char kConsoleMessage[] =
+    "{\"method\":\"Runtime.consoleAPICalled\",\"params\":{\"type\":\"log\","
+    "\"args\":[{\"type\":\"string\",\"value\":\"flood\"}]}}";
+
+// What InspectorIo used before AtomicQueue: pushes and the consumer's swap
+// of the whole queue behind one mutex.
+class LockedQueue {
+ public:
+  void Push(std::string message) {
+    std::lock_guard<std::mutex> lock(lock_);
+    pushed_.push_back(std::move(message));
+  }
+  bool Pop(std::string* message) {
+    if (taken_.empty()) {
+      std::lock_guard<std::mutex> lock(lock_);
+      taken_.swap(pushed_);
+    }
+    if (taken_.empty())
+      return false;
+    *message = std::move(taken_.front());
+    taken_.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex lock_;
+  std::deque<std::string> pushed_;
+  std::deque<std::string> taken_;  // Consumer only
+};
+
+// Returns the mean time per message in nanoseconds, from the first push to
+// the last pop.
+template <typename Queue>
+double FloodOnce(int producers) {
+  Queue queue;
+  uint64_t start = uv_hrtime();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < producers; i++) {
+    threads.emplace_back([&queue] {
+      for (int j = 0; j < kMessagesPerProducer; j++)
+        queue.Push(kConsoleMessage);
+    });
+  }
+  const int total = producers * kMessagesPerProducer;
+  std::string message;
+  for (int popped = 0; popped < total; ) {
+    if (queue.Pop(&message))
+      popped++;
+    else
+      std::this_thread::yield();
+  }
+  uint64_t elapsed = uv_hrtime() - start;
+  for (std::thread& thread : threads)
+    thread.join();
+  return static_cast<double>(elapsed) / total;
+}
+
+// The best of a few runs, the others being disturbed by the scheduler.
+template <typename Queue>
+double Flood(int producers) {
+  double best = FloodOnce<Queue>(producers);
+  for (int i = 1; i < kRuns; i++)
+    best = std::min(best, FloodOnce<Queue>(producers));
+  return best;
+}
+
+}  // namespace
+
+int main() {
+  const int kProducers[] = {1, 2, 4, 8};
+  for (int producers : kProducers) {
+    double locked = Flood<LockedQueue>(producers);
+    double atomic = Flood<inspector::AtomicQueue<std::string>>(producers);
+    printf("%d producers  locked %6.1f ns/msg  atomic %6.1f ns/msg\n",
+           producers, locked, atomic);
+  }
+  return 0;
+}
@@ -0,0 +1,160 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+// Agent startup cost on the thread that calls Agent::Prepare(). Resolving
+// the host, listening and finding the script path (what IOStartUp() does)
+// is timed on the caller thread, as startup used to do it, and on a thread
+// of its own, as the IO thread does it now: there the caller only pays for
+// creating the thread. The time until the server listens is shown for both.
+// Takes the host to resolve, "localhost" by default.
+
+#include "inspector_socket_server.h"
+#include "uv.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace inspector {
+extern FILE *gLogStream;
+}  // namespace inspector
+
+namespace {
+
+const int kWarmupStarts = 20;
+const int kStarts = 500;
+
+class NullDelegate : public inspector::SocketServerDelegate {
+ public:
+  bool StartSession(int session_id, const std::string& target_id) override {
+    return false;
+  }
+  void EndSession(int session_id) override { }
+  void MessageReceived(int session_id, std::string message,
+                       bool ascii) override { }
+  std::vector<std::string> GetTargetIds() override {
+    return std::vector<std::string>(1, "bench");
+  }
+  std::string GetTargetTitle(const std::string& id) override {
+    return "bench";
+  }
+  std::string GetTargetUrl(const std::string& id) override {
+    return "file://bench";
+  }
+  void ServerDone() override { }
+};
+
+struct Startup {
+  std::string host;
+  std::string script;
+  bool ok;
+  uint64_t listening_ns;
+};
+
+// Like IOStartUp(): find the script path, resolve and listen, then stop.
+void StartAndStop(Startup* startup) {
+  uv_loop_t loop;
+  uv_loop_init(&loop);
+  uv_fs_t req;
+  req.ptr = nullptr;
+  std::string script_path;
+  if (0 == uv_fs_realpath(&loop, &req, startup->script.c_str(), nullptr))
+    script_path = static_cast<char*>(req.ptr);
+  uv_fs_req_cleanup(&req);
+
+  NullDelegate delegate;
+  inspector::InspectorOptions options;
+  options.ping_interval_ms = 0;
+  inspector::InspectorStats stats;
+  std::unique_ptr<inspector::InspectorSocketServer> server(
+      new inspector::InspectorSocketServer(&delegate, &loop, startup->host, 0,
+                                           options, &stats, nullptr));
+  std::string url;
+  startup->ok = server->Start(url) && !script_path.empty();
+  startup->listening_ns = uv_hrtime();
+  if (startup->ok) {
+    server->Stop(nullptr);
+    uv_run(&loop, UV_RUN_DEFAULT);
+  }
+  server.reset();
+  uv_run(&loop, UV_RUN_NOWAIT);
+  uv_loop_close(&loop);
+}
+
+void ThreadMain(void* startup) {
+  StartAndStop(static_cast<Startup*>(startup));
+}
+
+double Median(std::vector<uint64_t>* samples) {
+  std::sort(samples->begin(), samples->end());
+  return (*samples)[samples->size() / 2] / 1000.0;
+}
+
+bool Run(const char* label, Startup* startup, bool on_thread) {
+  std::vector<uint64_t> blocked;
+  std::vector<uint64_t> listening;
+  for (int i = 0; i < kWarmupStarts + kStarts; i++) {
+    uint64_t start = uv_hrtime();
+    uint64_t returned;
+    if (on_thread) {
+      uv_thread_t thread;
+      if (uv_thread_create(&thread, ThreadMain, startup) != 0)
+        return false;
+      returned = uv_hrtime();
+      uv_thread_join(&thread);
+    } else {
+      StartAndStop(startup);
+      returned = startup->listening_ns;
+    }
+    if (!startup->ok) {
+      fprintf(stderr, "%s: could not start on %s\n", label,
+              startup->host.c_str());
+      return false;
+    }
+    if (i >= kWarmupStarts) {
+      blocked.push_back(returned - start);
+      listening.push_back(startup->listening_ns - start);
+    }
+  }
+  printf("%-9s caller blocked median %8.1f us  listening after %8.1f us\n",
+         label, Median(&blocked), Median(&listening));
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // The ready message is printed on every start.
+  inspector::gLogStream = fopen("/dev/null", "w");
+  if (inspector::gLogStream == nullptr)
+    inspector::gLogStream = stderr;
+  Startup startup;
+  startup.host = argc > 1 ? argv[1] : "localhost";
+  startup.script = argv[0];
+  bool ok = Run("caller", &startup, false) &&
+            Run("io thread", &startup, true);
+  return ok ? 0 : 1;
+}
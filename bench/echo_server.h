@@ -0,0 +1,133 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+#ifndef BENCH_ECHO_SERVER_H_
+#define BENCH_ECHO_SERVER_H_
+
+#include "inspector_socket_server.h"
+#include "uv.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// A transport (InspectorSocketServer, LoopbackTransport or ShmRingTransport)
+// on its own thread and loop, like the one InspectorIo runs, that sends
+// every message back to the session it came from. It serves a single
+// target, "bench".
+template <typename Transport>
+class EchoTransport : public inspector::SocketServerDelegate {
+ public:
+  explicit EchoTransport(const inspector::InspectorOptions& options)
+      : options_(options), port_(0), started_(false) { }
+
+  // Returns false if the transport could not start.
+  bool Start() {
+    uv_sem_init(&ready_, 0);
+    int err = uv_thread_create(&thread_, ThreadMain, this);
+    if (err != 0)
+      return false;
+    uv_sem_wait(&ready_);
+    uv_sem_destroy(&ready_);
+    if (!started_)
+      uv_thread_join(&thread_);
+    return started_;
+  }
+
+  // Stops the transport and joins the thread. Clients must have
+  // disconnected already.
+  void Stop() {
+    uv_async_send(&stop_async_);
+    uv_thread_join(&thread_);
+  }
+
+  Transport* transport() { return transport_.get(); }
+  int port() const { return port_; }
+  // What Start() of the transport reported, e.g. the shm:// line.
+  const std::string& url() const { return url_; }
+  inspector::InspectorStats* stats() { return &stats_; }
+
+  bool StartSession(int session_id, const std::string& target_id) override {
+    return true;
+  }
+  void EndSession(int session_id) override { }
+  void MessageReceived(int session_id, std::string message,
+                       bool ascii) override {
+    transport_->Send(session_id, std::move(message));
+  }
+  std::vector<std::string> GetTargetIds() override {
+    return std::vector<std::string>(1, "bench");
+  }
+  std::string GetTargetTitle(const std::string& id) override {
+    return "bench";
+  }
+  std::string GetTargetUrl(const std::string& id) override {
+    return "file://bench";
+  }
+  void ServerDone() override { }
+
+ private:
+  static void ThreadMain(void* arg) {
+    EchoTransport* self = static_cast<EchoTransport*>(arg);
+    uv_loop_init(&self->loop_);
+    self->transport_.reset(new Transport(self, &self->loop_, "127.0.0.1", 0,
+                                         self->options_, &self->stats_,
+                                         stderr));
+    self->started_ = self->transport_->Start(self->url_);
+    if (self->started_) {
+      self->port_ = self->transport_->Port();
+      uv_async_init(&self->loop_, &self->stop_async_, StopAsyncCb);
+      self->stop_async_.data = self;
+    }
+    uv_sem_post(&self->ready_);
+    if (self->started_)
+      uv_run(&self->loop_, UV_RUN_DEFAULT);
+    self->transport_.reset();
+    uv_run(&self->loop_, UV_RUN_NOWAIT);
+    uv_loop_close(&self->loop_);
+  }
+
+  static void StopAsyncCb(uv_async_t* async) {
+    EchoTransport* self = static_cast<EchoTransport*>(async->data);
+    self->transport_->Stop(nullptr);
+    uv_close(reinterpret_cast<uv_handle_t*>(async), nullptr);
+  }
+
+  inspector::InspectorOptions options_;
+  inspector::InspectorStats stats_;
+  std::unique_ptr<Transport> transport_;
+  std::string url_;
+  uv_loop_t loop_;
+  uv_thread_t thread_;
+  uv_sem_t ready_;
+  uv_async_t stop_async_;
+  int port_;
+  bool started_;
+};
+
+typedef EchoTransport<inspector::InspectorSocketServer> EchoServer;
+
+}  // namespace bench
+
+#endif  // BENCH_ECHO_SERVER_H_
@@ -0,0 +1,57 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+#ifndef BENCH_TEST_H_
+#define BENCH_TEST_H_
+
+#include <stdio.h>
+
+namespace bench {
+
+inline int& Failures() {
+  static int failures = 0;
+  return failures;
+}
+
+// Prints the outcome of a test program and returns its exit code.
+inline int TestResult(const char* name) {
+  if (Failures() == 0) {
+    printf("%s: passed\n", name);
+    return 0;
+  }
+  printf("%s: %d checks failed\n", name, Failures());
+  return 1;
+}
+
+}  // namespace bench
+
+// Failed checks are counted, so one run reports all of them. The first few
+// are printed.
+#define EXPECT(condition)                                                    \
+  do {                                                                       \
+    if (!(condition) && bench::Failures()++ < 20) {                          \
+      fprintf(stderr, "%s:%d: EXPECT(%s) failed\n", __FILE__, __LINE__,     \
+              #condition);                                                   \
+    }                                                                        \
+  } while (0)
+
+#endif  // BENCH_TEST_H_
@@ -0,0 +1,343 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+// Checks the JSON <-> CBOR translation against an encoder written from
+// RFC 7049 here, on random documents, and against the RFC's own examples.
+
+#include "inspector_cbor.h"
+#include "test.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int kIterations = 20000;
+
+std::string Bytes(std::initializer_list<int> bytes) {
+  std::string result;
+  for (int byte : bytes)
+    result.push_back(static_cast<char>(byte));
+  return result;
+}
+
+// Reference encoder: a head with the shortest argument, RFC 7049 2.1.
+void Head(int major, uint64_t value, std::string* cbor) {
+  int additional;
+  int bytes;
+  if (value < 24) {
+    additional = static_cast<int>(value);
+    bytes = 0;
+  } else if (value < 0x100) {
+    additional = 24;
+    bytes = 1;
+  } else if (value < 0x10000) {
+    additional = 25;
+    bytes = 2;
+  } else if (value < 0x100000000ull) {
+    additional = 26;
+    bytes = 4;
+  } else {
+    additional = 27;
+    bytes = 8;
+  }
+  cbor->push_back(static_cast<char>(major << 5 | additional));
+  for (int i = bytes - 1; i >= 0; i--)
+    cbor->push_back(static_cast<char>(value >> (8 * i)));
+}
+
+// A random document as JSON in random spacing, the CBOR the translation
+// must produce for it, and the JSON it must translate back to.
+struct Document {
+  std::string json;
+  std::string cbor;
+  std::string canonical;
+};
+
+class Generator {
+ public:
+  explicit Generator(uint32_t seed) : rng_(seed) { }
+
+  Document Next() {
+    Document document;
+    Value(0, &document);
+    return document;
+  }
+
+ private:
+  void Space(Document* document) {
+    static const char kSpace[] = " \t\r\n";
+    while (rng_() % 4 == 0)
+      document->json.push_back(kSpace[rng_() % 4]);
+  }
+
+  void Value(int depth, Document* document) {
+    Space(document);
+    int kind = rng_() % (depth < 6 ? 8 : 6);
+    switch (kind) {
+    case 0:
+      Literal(document);
+      break;
+    case 1:
+    case 2:
+      Integer(document);
+      break;
+    case 3:
+      Double(document);
+      break;
+    case 4:
+    case 5:
+      String(document);
+      break;
+    case 6:
+      Array(depth, document);
+      break;
+    default:
+      Object(depth, document);
+    }
+    Space(document);
+  }
+
+  void Literal(Document* document) {
+    static const char* const kLiterals[] = {"true", "false", "null"};
+    static const int kSimple[] = {0xf5, 0xf4, 0xf6};
+    int index = rng_() % 3;
+    document->json += kLiterals[index];
+    document->canonical += kLiterals[index];
+    document->cbor.push_back(static_cast<char>(kSimple[index]));
+  }
+
+  void Integer(Document* document) {
+    static const int64_t kEdges[] = {
+      0, 1, 23, 24, 255, 256, 65535, 65536, 4294967295ll, 4294967296ll,
+      INT64_MAX, -1, -24, -25, -256, -257, -65537, INT64_MIN
+    };
+    int64_t value = rng_() % 2 ? kEdges[rng_() % 18]
+                               : static_cast<int32_t>(rng_()) >> (rng_() % 31);
+    std::string text = std::to_string(value);
+    document->json += text;
+    document->canonical += text;
+    if (value >= 0)
+      Head(0, static_cast<uint64_t>(value), &document->cbor);
+    else
+      Head(1, static_cast<uint64_t>(-(value + 1)), &document->cbor);
+  }
+
+  void Double(Document* document) {
+    // Written as in the document and as printed back.
+    static const char* const kDoubles[][2] = {
+      {"1.5", "1.5"}, {"-0.25", "-0.25"}, {"3.14159", "3.14159"},
+      {"1e300", "1e+300"}, {"2.5E-3", "0.0025"}, {"1.0", "1"},
+      {"0.1", "0.1"}, {"-1e-7", "-1e-07"}, {"12345678.9", "12345678.9"}
+    };
+    int index = rng_() % 9;
+    double value = strtod(kDoubles[index][0], nullptr);
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    document->json += kDoubles[index][0];
+    document->canonical += kDoubles[index][1];
+    document->cbor.push_back(static_cast<char>(0xfb));
+    for (int i = 7; i >= 0; i--)
+      document->cbor.push_back(static_cast<char>(bits >> (8 * i)));
+  }
+
+  // Strings mix plain text, escapes and UTF-8, each with its decoded form
+  // and how the translation writes it back.
+  void String(Document* document) {
+    static const char* const kPieces[][3] = {
+      {"abc", "abc", "abc"},
+      {"Runtime.evaluate", "Runtime.evaluate", "Runtime.evaluate"},
+      {"\\\"", "\"", "\\\""}, {"\\\\", "\\", "\\\\"}, {"\\/", "/", "/"},
+      {"\\n", "\n", "\\n"}, {"\\t", "\t", "\\t"}, {"\\b", "\b", "\\b"},
+      {"\\u0001", "\x01", "\\u0001"}, {"\\u001f", "\x1f", "\\u001f"},
+      {"\\u00e9", "\xc3\xa9", "\xc3\xa9"}, {"\xc3\xa9", "\xc3\xa9", "\xc3\xa9"},
+      {"\\u20AC", "\xe2\x82\xac", "\xe2\x82\xac"},
+      {"\\ud83d\\ude00", "\xf0\x9f\x98\x80", "\xf0\x9f\x98\x80"},
+      {"\xf0\x9f\x98\x80", "\xf0\x9f\x98\x80", "\xf0\x9f\x98\x80"}
+    };
+    std::string text;
+    document->json.push_back('"');
+    document->canonical.push_back('"');
+    int pieces = rng_() % 6;
+    for (int i = 0; i < pieces; i++) {
+      int index = rng_() % 15;
+      document->json += kPieces[index][0];
+      text += kPieces[index][1];
+      document->canonical += kPieces[index][2];
+    }
+    document->json.push_back('"');
+    document->canonical.push_back('"');
+    Head(3, text.size(), &document->cbor);
+    document->cbor += text;
+  }
+
+  void Array(int depth, Document* document) {
+    document->json.push_back('[');
+    document->canonical.push_back('[');
+    document->cbor.push_back(static_cast<char>(0x9f));
+    int items = rng_() % 5;
+    for (int i = 0; i < items; i++) {
+      if (i > 0) {
+        document->json.push_back(',');
+        document->canonical.push_back(',');
+      }
+      Value(depth + 1, document);
+    }
+    Space(document);
+    document->json.push_back(']');
+    document->canonical.push_back(']');
+    document->cbor.push_back(static_cast<char>(0xff));
+  }
+
+  void Object(int depth, Document* document) {
+    document->json.push_back('{');
+    document->canonical.push_back('{');
+    document->cbor.push_back(static_cast<char>(0xbf));
+    int members = rng_() % 5;
+    for (int i = 0; i < members; i++) {
+      if (i > 0) {
+        document->json.push_back(',');
+        document->canonical.push_back(',');
+      }
+      Space(document);
+      String(document);
+      Space(document);
+      document->json.push_back(':');
+      document->canonical.push_back(':');
+      Value(depth + 1, document);
+    }
+    Space(document);
+    document->json.push_back('}');
+    document->canonical.push_back('}');
+    document->cbor.push_back(static_cast<char>(0xff));
+  }
+
+  std::mt19937 rng_;
+};
+
+void CheckRandomDocuments() {
+  Generator generator(1);
+  std::string cbor;
+  std::string json;
+  for (int i = 0; i < kIterations; i++) {
+    Document document = generator.Next();
+    EXPECT(inspector::JsonToCbor(document.json.data(), document.json.size(),
+                                 &cbor));
+    EXPECT(cbor == document.cbor);
+    EXPECT(inspector::CborToJson(document.cbor.data(), document.cbor.size(),
+                                 &json));
+    EXPECT(json == document.canonical);
+  }
+}
+
+std::string ToJson(const std::string& cbor) {
+  std::string json;
+  if (!inspector::CborToJson(cbor.data(), cbor.size(), &json))
+    return "<invalid>";
+  return json;
+}
+
+// Encodings the writer never produces, from RFC 7049 Appendix A.
+void CheckRfcExamples() {
+  EXPECT(ToJson(Bytes({0x1b, 0, 0, 0, 0xe8, 0xd4, 0xa5, 0x10, 0})) ==
+         "1000000000000");
+  EXPECT(ToJson(Bytes({0x39, 0x03, 0xe7})) == "-1000");
+  EXPECT(ToJson(Bytes({0xf9, 0x3c, 0x00})) == "1");
+  EXPECT(ToJson(Bytes({0xf9, 0xc4, 0x00})) == "-4");
+  EXPECT(ToJson(Bytes({0xf9, 0x00, 0x01})) == "5.9604644775390625e-08");
+  EXPECT(ToJson(Bytes({0xf9, 0x7c, 0x00})) == "null");
+  EXPECT(ToJson(Bytes({0xfa, 0x47, 0xc3, 0x50, 0x00})) == "100000");
+  EXPECT(ToJson(Bytes({0xf7})) == "null");
+  EXPECT(ToJson(Bytes({0x83, 0x01, 0x82, 0x02, 0x03, 0x82, 0x04, 0x05})) ==
+         "[1,[2,3],[4,5]]");
+  EXPECT(ToJson(Bytes({0xa2, 0x61, 0x61, 0x01, 0x61, 0x62, 0x82, 0x02,
+                       0x03})) == "{\"a\":1,\"b\":[2,3]}");
+  EXPECT(ToJson(Bytes({0x9f, 0x01, 0x82, 0x02, 0x03, 0x9f, 0x04, 0x05, 0xff,
+                       0xff})) == "[1,[2,3],[4,5]]");
+  EXPECT(ToJson(Bytes({0x7f, 0x65, 0x73, 0x74, 0x72, 0x65, 0x61, 0x64, 0x6d,
+                       0x69, 0x6e, 0x67, 0xff})) == "\"streaming\"");
+  // Byte strings become base64 text.
+  EXPECT(ToJson(Bytes({0x44, 0x01, 0x02, 0x03, 0x04})) == "\"AQIDBA==\"");
+  // Other tags only wrap their item.
+  EXPECT(ToJson(Bytes({0xc1, 0x1a, 0x51, 0x4b, 0x67, 0xb0})) == "1363896240");
+  // Tag 24 around a byte string holding a whole message.
+  EXPECT(ToJson(Bytes({0xd8, 0x18, 0x45, 0xbf, 0x61, 0x61, 0x01, 0xff})) ==
+         "{\"a\":1}");
+}
+
+// The integer 1 in count tag 24 envelopes, each one inside the next.
+std::string NestedEnvelopes(int count) {
+  std::vector<std::string> heads;
+  size_t size = 1;
+  for (int i = 0; i < count; i++) {
+    std::string head = Bytes({0xd8, 0x18});
+    Head(2, size, &head);
+    size += head.size();
+    heads.push_back(head);
+  }
+  std::string cbor;
+  for (auto head = heads.rbegin(); head != heads.rend(); ++head)
+    cbor += *head;
+  return cbor + Bytes({0x01});
+}
+
+void CheckMalformed() {
+  // Truncated head, string and container.
+  EXPECT(ToJson(Bytes({0x19, 0x01})) == "<invalid>");
+  EXPECT(ToJson(Bytes({0x63, 0x61, 0x62})) == "<invalid>");
+  EXPECT(ToJson(Bytes({0x9f, 0x01})) == "<invalid>");
+  EXPECT(ToJson(Bytes({0x82, 0x01})) == "<invalid>");
+  // A break outside of an indefinite container, trailing data.
+  EXPECT(ToJson(Bytes({0xff})) == "<invalid>");
+  EXPECT(ToJson(Bytes({0x01, 0x02})) == "<invalid>");
+  // JSON object keys must be text.
+  EXPECT(ToJson(Bytes({0xa1, 0x01, 0x02})) == "<invalid>");
+  // Too deep for the reader's stack guard.
+  EXPECT(ToJson(std::string(1000, '\x81') + '\x01') == "<invalid>");
+  // An envelope must hold exactly one item, and nested envelopes count
+  // toward the depth like containers do.
+  EXPECT(ToJson(Bytes({0xd8, 0x18, 0x42, 0x01, 0x02})) == "<invalid>");
+  EXPECT(ToJson(Bytes({0xd8, 0x18, 0x42, 0x01})) == "<invalid>");
+  EXPECT(ToJson(NestedEnvelopes(10)) == "1");
+  EXPECT(ToJson(NestedEnvelopes(20000)) == "<invalid>");
+  std::string cbor;
+  std::string deep = std::string(1000, '[') + std::string(1000, ']');
+  EXPECT(!inspector::JsonToCbor(deep.data(), deep.size(), &cbor));
+  const char* const kBadJson[] = {
+    "", "{", "[1,]", "{\"a\"}", "tru", "\"\\x\"", "01x", "1 2", "\"abc"
+  };
+  for (const char* json : kBadJson)
+    EXPECT(!inspector::JsonToCbor(json, strlen(json), &cbor));
+}
+
+}  // namespace
+
+int main() {
+  CheckRandomDocuments();
+  CheckRfcExamples();
+  CheckMalformed();
+  return bench::TestResult("test_cbor");
+}
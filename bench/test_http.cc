@@ -0,0 +1,144 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+// The fast path for request heads arriving in one read must answer exactly
+// like http_parser. Each request is sent whole, which takes the fast path
+// where it applies, and again split in two writes with a pause in between,
+// which always goes through http_parser. The responses must be the same.
+
+#include "echo_server.h"
+#include "test.h"
+#include "ws_client.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+
+namespace {
+
+const char* const kRequests[] = {
+  // Served from the caches, in every spelling of the headers.
+  "GET /json/version HTTP/1.1\r\nHost: localhost\r\n\r\n",
+  "GET /json/list HTTP/1.1\r\nHost: localhost\r\n\r\n",
+  "GET /json HTTP/1.1\r\nHost: localhost\r\n\r\n",
+  "GET /json/list?offset=0&limit=1 HTTP/1.1\r\nHost: localhost\r\n\r\n",
+  "GET /json/list HTTP/1.1\r\nHost: localhost\r\nIf-None-Match: *\r\n\r\n",
+  "GET /json/list HTTP/1.1\r\nif-none-match: \"x\", *\r\n\r\n",
+  "GET /json/version HTTP/1.1\r\nConnection: close\r\n\r\n",
+  "GET /json/version HTTP/1.0\r\n\r\n",
+  "GET /json/version HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n",
+  "GET /json/version HTTP/1.1\r\nHost:    localhost   \r\n\r\n",
+  "GET /json/protocol HTTP/1.1\r\nAccept-Encoding: gzip, deflate\r\n\r\n",
+  "GET /json/protocol HTTP/1.1\r\nAccept-Encoding: deflate\r\n\r\n",
+  "GET /json/protocol HTTP/1.1\r\nAccept-Encoding: gzip;q=0\r\n\r\n",
+  "GET /json/activate/bench HTTP/1.1\r\n\r\n",
+  "GET /json/activate/nope HTTP/1.1\r\n\r\n",
+  "GET /nothing HTTP/1.1\r\n\r\n",
+  // WebSocket upgrades, accepted and refused.
+  "GET /bench HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n"
+  "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+  "Sec-WebSocket-Version: 13\r\n\r\n",
+  "GET /bench HTTP/1.1\r\nupgrade: WebSocket\r\n"
+  "CONNECTION: keep-alive, Upgrade\r\n"
+  "sec-websocket-key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n",
+  "GET /bench HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+  "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+  "Sec-WebSocket-Extensions: permessage-deflate; "
+  "client_max_window_bits\r\n\r\n",
+  "GET /nope HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+  "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n",
+  "GET /bench HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n\r\n",
+  // What the fast path leaves to http_parser.
+  "POST /json/version HTTP/1.1\r\nContent-Length: 0\r\n\r\n",
+  "GET /json/version HTTP/1.1\r\nContent-Length: 2\r\n\r\n{}",
+  "GET /json/version HTTP/1.1\r\nHost: a\r\n b\r\n\r\n",
+  "GET /json/version HTTP/1.1\r\nHost a\r\n\r\n",
+  "GET /json/version HTTP/1.1x\r\n\r\n",
+  "GET /json/version HTTP/1.1\r\n\r\nGET /json/list HTTP/1.1\r\n\r\n",
+  "GET /json/version HTTP/1.1\nHost: localhost\n\n",
+  "get /json/version HTTP/1.1\r\n\r\n",
+};
+
+// The whole response: the head, then Content-Length bytes of body, or
+// everything up to the server closing the connection.
+std::string Exchange(int port, const std::string& request, size_t split) {
+  bench::WsClient client;
+  if (!client.ConnectTcp(port))
+    return "<connect failed>";
+  bool sent;
+  if (split == 0) {
+    sent = client.SendRaw(request.data(), request.size());
+  } else {
+    sent = client.SendRaw(request.data(), split);
+    // Long enough for the server to read the first part on its own.
+    usleep(20 * 1000);
+    sent = sent && client.SendRaw(request.data() + split,
+                                  request.size() - split);
+  }
+  std::string response;
+  if (!sent || !client.ReadHead(&response))
+    return response + "<closed>";
+  // Neither carries a body.
+  if (response.compare(0, 12, "HTTP/1.1 101") == 0 ||
+      response.compare(0, 12, "HTTP/1.1 304") == 0) {
+    return response;
+  }
+  size_t length = response.find("Content-Length: ");
+  if (length != std::string::npos) {
+    std::string body(strtoul(response.c_str() + length + 16, nullptr, 10),
+                     '\0');
+    if (!body.empty() && !client.ReadExact(&body[0], body.size()))
+      return response + "<short body>";
+    return response + body;
+  }
+  client.ReadToEnd(&response);
+  return response;
+}
+
+}  // namespace
+
+int main() {
+  inspector::InspectorOptions options;
+  options.ping_interval_ms = 0;
+  bench::EchoServer server(options);
+  if (!server.Start()) {
+    fprintf(stderr, "server did not start\n");
+    return 1;
+  }
+  for (const char* request : kRequests) {
+    std::string text = request;
+    std::string whole = Exchange(server.port(), text, 0);
+    const size_t kSplits[] = {1, text.size() / 2, text.size() - 1};
+    for (size_t split : kSplits) {
+      std::string parsed = Exchange(server.port(), text, split);
+      if (parsed != whole) {
+        fprintf(stderr, "request:\n%s\nwhole:\n%s\nsplit at %zu:\n%s\n",
+                request, whole.substr(0, 400).c_str(), split,
+                parsed.substr(0, 400).c_str());
+      }
+      EXPECT(parsed == whole);
+    }
+  }
+  server.Stop();
+  return bench::TestResult("test_http");
+}
@@ -0,0 +1,112 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+// AtomicQueue with rings small enough that pushes keep overflowing: every
+// entry comes out once, each producer's in order, and a consumer that
+// sleeps the way InspectorIo::DispatchMessages() does is never left asleep
+// with entries pending.
+
+#include "inspector_queue.h"
+#include "test.h"
+#include "uv.h"
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+typedef std::pair<int, int> Entry;  // Producer, sequence number
+
+void CheckSingleThread() {
+  inspector::AtomicQueue<int> queue(4);
+  EXPECT(!queue.Pending());
+  EXPECT(queue.Front() == nullptr);
+  for (int i = 0; i < 3; i++)
+    queue.Push(i);
+  int value = -1;
+  EXPECT(queue.Pop(&value) && value == 0);
+  // Fills the ring, the rest overflows.
+  for (int i = 3; i < 12; i++)
+    queue.Push(i);
+  for (int i = 1; i < 12; i++) {
+    EXPECT(queue.Pending());
+    EXPECT(queue.Front() != nullptr && *queue.Front() == i);
+    EXPECT(queue.Pop(&value) && value == i);
+  }
+  EXPECT(!queue.Pending());
+  EXPECT(!queue.Pop(&value));
+  // The ring is used again once the overflow is drained.
+  queue.Push(12);
+  EXPECT(queue.Pop(&value) && value == 12);
+}
+
+void CheckProducers(int producers, int per_producer, size_t capacity) {
+  inspector::AtomicQueue<Entry> queue(capacity);
+  std::atomic<bool> dispatch_pending(false);
+  uv_sem_t wakeup;
+  uv_sem_init(&wakeup, 0);
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.emplace_back([&, p] {
+      for (int i = 0; i < per_producer; i++) {
+        queue.Push(Entry(p, i));
+        if (!dispatch_pending.exchange(true))
+          uv_sem_post(&wakeup);
+      }
+    });
+  }
+  std::vector<int> expected(producers, 0);
+  int received = 0;
+  bool in_order = true;
+  while (received < producers * per_producer) {
+    uv_sem_wait(&wakeup);
+    for (;;) {
+      Entry entry;
+      while (queue.Pop(&entry)) {
+        in_order = in_order && entry.second == expected[entry.first]++;
+        received++;
+      }
+      dispatch_pending = false;
+      if (!queue.Pending())
+        break;
+      dispatch_pending = true;
+    }
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  EXPECT(in_order);
+  EXPECT(received == producers * per_producer);
+  EXPECT(!queue.Pending());
+  uv_sem_destroy(&wakeup);
+}
+
+}  // namespace
+
+int main() {
+  CheckSingleThread();
+  CheckProducers(1, 100000, 8);
+  CheckProducers(4, 50000, 8);
+  CheckProducers(8, 20000, 1024);
+  return bench::TestResult("test_queue");
+}
@@ -0,0 +1,229 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+// Drives ShmRingTransport as a collector would, with the record framing
+// written from the layout documented in inspector_shm.h. Messages must come
+// back in order and whole, also ones larger than a ring. The collector runs
+// in the same process, so the descriptors in the shm:// line are used as
+// they are instead of being taken over with pidfd_getfd.
+
+#include "echo_server.h"
+#include "inspector_shm.h"
+#include "test.h"
+
+#include <poll.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+
+using inspector::ShmRecordHeader;
+using inspector::ShmRingIndex;
+
+namespace {
+
+// Small rings, so that large messages wrap and get fragmented.
+const size_t kRingSize = 4096;
+const int kMessages = 2000;
+
+class Collector {
+ public:
+  bool Attach(const std::string& url) {
+    int pid;
+    size_t ring_size;
+    if (sscanf(url.c_str(), "shm://%d?memfd=%d&inspector_eventfd=%d&"
+                            "collector_eventfd=%d&ring_size=%zu",
+               &pid, &memfd_, &inspector_eventfd_, &collector_eventfd_,
+               &ring_size) != 5) {
+      return false;
+    }
+    ring_size_ = ring_size;
+    void* segment = mmap(nullptr, inspector::kShmDataOffset + 2 * ring_size_,
+                         PROT_READ | PROT_WRITE, MAP_SHARED, memfd_, 0);
+    if (segment == MAP_FAILED)
+      return false;
+    segment_ = static_cast<char*>(segment);
+    const inspector::ShmSegmentHeader* header =
+        reinterpret_cast<const inspector::ShmSegmentHeader*>(segment_);
+    return header->magic == inspector::kShmMagic &&
+           header->version == inspector::kShmVersion &&
+           header->ring_size == ring_size_;
+  }
+
+  // Writes a record, split into kShmFragment records if the message does not
+  // fit the free part of the ring. Waits for room.
+  bool Put(uint32_t type, const std::string& message) {
+    ShmRingIndex* index = Index(inspector::kShmToInspectorIndex);
+    char* data = segment_ + inspector::kShmDataOffset;
+    size_t offset = 0;
+    int waited_ms = 0;
+    do {
+      uint64_t head = index->head.load();
+      size_t space = ring_size_ - (head - index->tail.load());
+      size_t length = message.size() - offset;
+      uint32_t record_type = type;
+      if (RecordSize(length) > space) {
+        if (space <= sizeof(ShmRecordHeader)) {
+          if (!Wait(&waited_ms))
+            return false;
+          continue;
+        }
+        length = space - sizeof(ShmRecordHeader);
+        record_type = inspector::kShmFragment;
+      }
+      ShmRecordHeader header = {static_cast<uint32_t>(length), record_type};
+      Copy(data, head, reinterpret_cast<const char*>(&header),
+           sizeof(header));
+      Copy(data, head + sizeof(header), message.data() + offset, length);
+      index->head.store(head + RecordSize(length));
+      Notify();
+      offset += length;
+      waited_ms = 0;
+    } while (offset < message.size());
+    return true;
+  }
+
+  // Reads the next message, joining fragments.
+  bool Get(uint32_t* type, std::string* message) {
+    ShmRingIndex* index = Index(inspector::kShmToCollectorIndex);
+    const char* data = segment_ + inspector::kShmDataOffset + ring_size_;
+    message->clear();
+    int waited_ms = 0;
+    for (;;) {
+      uint64_t tail = index->tail.load();
+      if (index->head.load() == tail) {
+        if (!Wait(&waited_ms))
+          return false;
+        continue;
+      }
+      ShmRecordHeader header;
+      Read(data, tail, reinterpret_cast<char*>(&header), sizeof(header));
+      size_t start = message->size();
+      message->resize(start + header.length);
+      Read(data, tail + sizeof(header), &(*message)[start], header.length);
+      index->tail.store(tail + RecordSize(header.length));
+      Notify();
+      waited_ms = 0;
+      if (header.type != inspector::kShmFragment) {
+        *type = header.type;
+        return true;
+      }
+    }
+  }
+
+ private:
+  ShmRingIndex* Index(size_t offset) {
+    return reinterpret_cast<ShmRingIndex*>(segment_ + offset);
+  }
+
+  static size_t RecordSize(size_t length) {
+    return sizeof(ShmRecordHeader) + ((length + 7) & ~static_cast<size_t>(7));
+  }
+
+  void Copy(char* data, uint64_t position, const char* from, size_t length) {
+    for (size_t i = 0; i < length; i++)
+      data[(position + i) % ring_size_] = from[i];
+  }
+
+  void Read(const char* data, uint64_t position, char* to, size_t length) {
+    for (size_t i = 0; i < length; i++)
+      to[i] = data[(position + i) % ring_size_];
+  }
+
+  void Notify() {
+    uint64_t one = 1;
+    EXPECT(write(inspector_eventfd_, &one, sizeof(one)) == sizeof(one));
+  }
+
+  // The reader and the writer thread share the eventfd, and either may
+  // take the other's wakeup, so this polls briefly and the caller checks
+  // its ring again. Returns false after five seconds without progress.
+  bool Wait(int* waited_ms) {
+    const int kPollMs = 10;
+    pollfd fd = {collector_eventfd_, POLLIN, 0};
+    if (poll(&fd, 1, kPollMs) == 1) {
+      uint64_t count;
+      EXPECT(read(collector_eventfd_, &count, sizeof(count)) ==
+             sizeof(count));
+    }
+    *waited_ms += kPollMs;
+    return *waited_ms < 5000;
+  }
+
+  char* segment_ = nullptr;
+  size_t ring_size_ = 0;
+  int memfd_ = -1;
+  int inspector_eventfd_ = -1;
+  int collector_eventfd_ = -1;
+};
+
+}  // namespace
+
+int main() {
+  inspector::InspectorOptions options;
+  options.shm_ring_size = kRingSize;
+  bench::EchoTransport<inspector::ShmRingTransport> transport(options);
+  if (!transport.Start()) {
+    fprintf(stderr, "transport did not start\n");
+    return 1;
+  }
+  Collector collector;
+  EXPECT(collector.Attach(transport.url()));
+  EXPECT(collector.Put(inspector::kShmAttach, ""));
+
+  // Small messages, then ones that wrap and are split in both directions.
+  // The writer runs ahead, so both rings fill up.
+  std::string large(3 * kRingSize + 13, 'L');
+  std::thread writer([&] {
+    for (int i = 0; i < kMessages; i++)
+      EXPECT(collector.Put(inspector::kShmMessage, "m" + std::to_string(i)));
+    for (int i = 0; i < 5; i++)
+      EXPECT(collector.Put(inspector::kShmMessage, large + std::to_string(i)));
+  });
+  uint32_t type;
+  std::string message;
+  for (int i = 0; i < kMessages; i++) {
+    EXPECT(collector.Get(&type, &message));
+    EXPECT(type == inspector::kShmMessage);
+    EXPECT(message == "m" + std::to_string(i));
+  }
+  for (int i = 0; i < 5; i++) {
+    EXPECT(collector.Get(&type, &message));
+    EXPECT(message == large + std::to_string(i));
+  }
+  writer.join();
+
+  // One session at a time, a second attach is refused and leaves the
+  // first one attached.
+  EXPECT(collector.Put(inspector::kShmAttach, ""));
+  EXPECT(collector.Get(&type, &message));
+  EXPECT(type == inspector::kShmAttachRefused);
+  EXPECT(collector.Put(inspector::kShmMessage, "still attached"));
+  EXPECT(collector.Get(&type, &message));
+  EXPECT(type == inspector::kShmMessage && message == "still attached");
+  EXPECT(collector.Put(inspector::kShmDetach, ""));
+  EXPECT(transport.stats()->shm_messages_in >= kMessages + 5u);
+  transport.Stop();
+  return bench::TestResult("test_shm");
+}
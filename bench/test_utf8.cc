@@ -0,0 +1,178 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+// Checks the UTF-8 kernels against ICU on random input, at every alignment
+// and length around the vector widths.
+
+#include "inspector_utf8.h"
+#include "test.h"
+
+#include "unicode/unistr.h"
+#include "unicode/ustring.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using inspector::Utf8Kind;
+
+namespace {
+
+const int kIterations = 100000;
+
+// Pieces of valid UTF-8: ASCII runs and sequences of every length, including
+// the largest code point of each length.
+const char* const kValidPieces[] = {
+  "a", "{\"id\":1,\"method\":\"Runtime.evaluate\"}",
+  "0123456789abcdef0123456789abcdef", "\xc2\x80", "\xc3\xa9", "\xdf\xbf",
+  "\xe0\xa0\x80", "\xe2\x82\xac", "\xed\x9f\xbf", "\xee\x80\x80",
+  "\xef\xbf\xbf", "\xf0\x90\x80\x80", "\xf0\x9f\x98\x80", "\xf4\x8f\xbf\xbf"
+};
+
+// Bytes that are likely to form or break sequences.
+const unsigned char kBytes[] = {
+  'a', 0x7f, 0x80, 0xbf, 0xc0, 0xc1, 0xc2, 0xdf, 0xe0, 0xed, 0xef, 0xf0,
+  0xf4, 0xf5, 0xff, 0xa0, 0x9f, 0x8f, 0x90
+};
+
+bool IcuValid(const std::string& text) {
+  UErrorCode status = U_ZERO_ERROR;
+  int32_t length;
+  u_strFromUTF8(nullptr, 0, &length, text.data(),
+                static_cast<int32_t>(text.size()), &status);
+  return status != U_INVALID_CHAR_FOUND && status != U_ILLEGAL_CHAR_FOUND;
+}
+
+// Copies text to the given offset of a buffer, so that the kernels see every
+// alignment of their vector loads.
+const char* Place(const std::string& text, size_t offset,
+                  std::vector<char>* buffer) {
+  buffer->assign(offset + text.size() + 1, '\0');
+  text.copy(&(*buffer)[offset], text.size());
+  return &(*buffer)[offset];
+}
+
+void CheckValid(std::mt19937* rng) {
+  std::string text;
+  bool ascii = true;
+  int pieces = (*rng)() % 40;
+  for (int i = 0; i < pieces; i++) {
+    size_t index = (*rng)() % (sizeof(kValidPieces) / sizeof(kValidPieces[0]));
+    text += kValidPieces[index];
+    ascii = ascii && index < 3;
+  }
+  std::vector<char> buffer;
+  const char* data = Place(text, (*rng)() % 32, &buffer);
+
+  Utf8Kind kind = inspector::ClassifyUtf8(data, text.size());
+  EXPECT(kind == (ascii ? Utf8Kind::kAscii : Utf8Kind::kUtf8));
+
+  std::vector<uint16_t> out(text.size() + 1);
+  size_t length = inspector::Utf8ToUtf16(data, text.size(), out.data());
+  icu::UnicodeString expected = icu::UnicodeString::fromUTF8(
+      icu::StringPiece(text.data(), static_cast<int32_t>(text.size())));
+  EXPECT(length == static_cast<size_t>(expected.length()));
+  EXPECT(std::equal(out.begin(), out.begin() + length,
+                    reinterpret_cast<const uint16_t*>(expected.getBuffer())));
+}
+
+void CheckArbitrary(std::mt19937* rng) {
+  std::string text;
+  int bytes = (*rng)() % 48;
+  for (int i = 0; i < bytes; i++) {
+    if ((*rng)() % 3 == 0)
+      text += kValidPieces[(*rng)() % 14];
+    else
+      text.push_back(static_cast<char>(kBytes[(*rng)() % sizeof(kBytes)]));
+  }
+  std::vector<char> buffer;
+  const char* data = Place(text, (*rng)() % 32, &buffer);
+  bool valid = inspector::ClassifyUtf8(data, text.size()) != Utf8Kind::kInvalid;
+  EXPECT(valid == IcuValid(text));
+  // Replacement is done per byte, unlike ICU, so only check the bound.
+  std::vector<uint16_t> out(text.size() + 1);
+  EXPECT(inspector::Utf8ToUtf16(data, text.size(), out.data()) <= text.size());
+}
+
+void CheckUtf16(std::mt19937* rng) {
+  std::vector<uint16_t> text;
+  int units = (*rng)() % 120;
+  for (int i = 0; i < units; i++) {
+    switch ((*rng)() % 10) {
+    case 6:
+      text.push_back(0x80 + (*rng)() % 0x780);
+      break;
+    case 7:
+      text.push_back(0x800 + (*rng)() % 0xd000);
+      break;
+    case 8:  // A surrogate pair
+      text.push_back(0xd800 + (*rng)() % 0x400);
+      text.push_back(0xdc00 + (*rng)() % 0x400);
+      break;
+    case 9:  // A lone surrogate, becomes U+FFFD
+      text.push_back(0xd800 + (*rng)() % 0x800);
+      break;
+    default:
+      text.push_back('a' + (*rng)() % 26);
+    }
+  }
+  size_t length = inspector::Utf16ToUtf8Length(text.data(), text.size());
+  std::string out(length + 1, '\x55');
+  size_t written = inspector::Utf16ToUtf8(text.data(), text.size(), &out[0]);
+  std::string expected;
+  icu::UnicodeString(reinterpret_cast<const UChar*>(text.data()),
+                     static_cast<int32_t>(text.size())).toUTF8String(expected);
+  EXPECT(written == length);
+  EXPECT(out.compare(0, length, expected) == 0);
+  EXPECT(out[length] == '\x55');
+}
+
+void CheckLatin1(std::mt19937* rng) {
+  std::vector<uint8_t> text;
+  int bytes = (*rng)() % 120;
+  icu::UnicodeString reference;
+  for (int i = 0; i < bytes; i++) {
+    uint8_t c = (*rng)() % 4 ? 'a' + (*rng)() % 26 : (*rng)() % 256;
+    text.push_back(c);
+    reference.append(static_cast<UChar>(c));
+  }
+  size_t length = inspector::Latin1ToUtf8Length(text.data(), text.size());
+  std::string out(length, '\0');
+  size_t written = inspector::Latin1ToUtf8(text.data(), text.size(), &out[0]);
+  std::string expected;
+  reference.toUTF8String(expected);
+  EXPECT(written == length);
+  EXPECT(out == expected);
+}
+
+}  // namespace
+
+int main() {
+  std::mt19937 rng(1);
+  for (int i = 0; i < kIterations; i++) {
+    CheckValid(&rng);
+    CheckArbitrary(&rng);
+    CheckUtf16(&rng);
+    CheckLatin1(&rng);
+  }
+  return bench::TestResult("test_utf8");
+}
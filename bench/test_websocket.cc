@@ -0,0 +1,238 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+// permessage-deflate negotiation (RFC 7692) and reassembly of fragmented
+// messages, checked from the client side of a real connection.
+
+#include "echo_server.h"
+#include "test.h"
+#include "ws_client.h"
+
+#include "zlib.h"
+
+#include <random>
+#include <string>
+
+namespace {
+
+const uint8_t kFin = 0x80;
+const uint8_t kRsv1 = 0x40;
+const uint8_t kOpCodeContinuation = 0;
+const uint8_t kOpCodeText = 1;
+const uint8_t kOpCodePing = 9;
+const uint8_t kOpCodePong = 10;
+
+// The Sec-WebSocket-Extensions the server answers an offer with, "<none>"
+// if it accepts none, or "<failed>" if the handshake fails.
+std::string Negotiate(int port, const std::string& offer) {
+  bench::WsClient client;
+  std::string response;
+  if (!client.ConnectTcp(port) ||
+      !client.Handshake("bench", "Sec-WebSocket-Extensions: " + offer + "\r\n",
+                        &response)) {
+    return "<failed>";
+  }
+  const char kHeader[] = "Sec-WebSocket-Extensions: ";
+  size_t start = response.find(kHeader);
+  if (start == std::string::npos)
+    return "<none>";
+  start += sizeof(kHeader) - 1;
+  return response.substr(start, response.find("\r\n", start) - start);
+}
+
+void CheckNegotiation() {
+  inspector::InspectorOptions options;
+  options.ping_interval_ms = 0;
+  bench::EchoServer server(options);
+  EXPECT(server.Start());
+  int port = server.port();
+  EXPECT(Negotiate(port, "permessage-deflate") == "permessage-deflate");
+  EXPECT(Negotiate(port, "permessage-deflate; client_max_window_bits") ==
+         "permessage-deflate");
+  EXPECT(Negotiate(port, "permessage-deflate; server_max_window_bits=10") ==
+         "permessage-deflate; server_max_window_bits=10");
+  EXPECT(Negotiate(port, "permessage-deflate;client_max_window_bits=\"12\"") ==
+         "permessage-deflate; client_max_window_bits=12");
+  EXPECT(Negotiate(port, "permessage-deflate; client_no_context_takeover") ==
+         "permessage-deflate; client_no_context_takeover");
+  EXPECT(Negotiate(port, "PERMESSAGE-DEFLATE; server_no_context_takeover; "
+                         "client_max_window_bits=9") ==
+         "permessage-deflate; server_no_context_takeover; "
+         "client_max_window_bits=9");
+  // zlib cannot meet an 8 bit window, the next offer is taken instead.
+  EXPECT(Negotiate(port, "permessage-deflate; server_max_window_bits=8, "
+                         "permessage-deflate; server_max_window_bits=9") ==
+         "permessage-deflate; server_max_window_bits=9");
+  EXPECT(Negotiate(port, "x-webkit-deflate-frame, permessage-deflate") ==
+         "permessage-deflate");
+  // Unknown parameters and bad values decline the offer, not the upgrade.
+  EXPECT(Negotiate(port, "permessage-deflate; unknown") == "<none>");
+  EXPECT(Negotiate(port, "permessage-deflate; server_max_window_bits=16") ==
+         "<none>");
+  EXPECT(Negotiate(port, "permessage-deflate; client_max_window_bits=x") ==
+         "<none>");
+  EXPECT(Negotiate(port, "x-webkit-deflate-frame") == "<none>");
+  server.Stop();
+
+  options.deflate_window_bits = 11;
+  options.deflate_context_takeover = false;
+  bench::EchoServer limited(options);
+  EXPECT(limited.Start());
+  EXPECT(Negotiate(limited.port(),
+                   "permessage-deflate; client_max_window_bits") ==
+         "permessage-deflate; server_no_context_takeover; "
+         "client_no_context_takeover; server_max_window_bits=11; "
+         "client_max_window_bits=11");
+  EXPECT(Negotiate(limited.port(), "permessage-deflate") ==
+         "permessage-deflate; server_no_context_takeover; "
+         "client_no_context_takeover; server_max_window_bits=11");
+  limited.Stop();
+
+  options.deflate_enabled = false;
+  bench::EchoServer disabled(options);
+  EXPECT(disabled.Start());
+  EXPECT(Negotiate(disabled.port(), "permessage-deflate") == "<none>");
+  disabled.Stop();
+}
+
+// Raw deflate with the trailing empty block removed, as RFC 7692 7.2.1.
+std::string Deflate(z_stream* strm, const std::string& data) {
+  std::string out(deflateBound(strm, data.size()) + 16, '\0');
+  strm->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  strm->avail_in = static_cast<uInt>(data.size());
+  strm->next_out = reinterpret_cast<Bytef*>(&out[0]);
+  strm->avail_out = static_cast<uInt>(out.size());
+  deflate(strm, Z_SYNC_FLUSH);
+  out.resize(out.size() - strm->avail_out - 4);
+  return out;
+}
+
+std::string Inflate(z_stream* strm, std::string data) {
+  data.append("\x00\x00\xff\xff", 4);
+  std::string out;
+  char buffer[4096];
+  strm->next_in = reinterpret_cast<Bytef*>(&data[0]);
+  strm->avail_in = static_cast<uInt>(data.size());
+  do {
+    strm->next_out = reinterpret_cast<Bytef*>(buffer);
+    strm->avail_out = sizeof(buffer);
+    int err = inflate(strm, Z_SYNC_FLUSH);
+    if (err != Z_OK && err != Z_BUF_ERROR)
+      return "<inflate failed>";
+    out.append(buffer, sizeof(buffer) - strm->avail_out);
+  } while (strm->avail_in > 0 || strm->avail_out == 0);
+  return out;
+}
+
+// Reads the next data message, answering nothing. Pongs are skipped.
+bool ReadMessage(bench::WsClient* client, uint8_t* first_byte,
+                 std::string* message) {
+  do {
+    if (!client->ReadFrame(first_byte, message))
+      return false;
+  } while ((*first_byte & 0x0f) == kOpCodePong);
+  return true;
+}
+
+std::string RandomText(std::mt19937* rng, size_t length) {
+  static const char* const kWords[] = {
+    "\"id\":", "1,", "\"method\"", ":", "\"Runtime", ".evaluate\"", "{", "}",
+    "caf\xc3\xa9", "\xe2\x82\xac"
+  };
+  std::string text;
+  while (text.size() < length)
+    text += kWords[(*rng)() % 10];
+  return text;
+}
+
+// Messages sent compressed or not, in one frame or in random fragments with
+// pings between them, must come back whole.
+void CheckFragments() {
+  inspector::InspectorOptions options;
+  options.ping_interval_ms = 0;
+  options.deflate_threshold = 64;
+  bench::EchoServer server(options);
+  EXPECT(server.Start());
+  bench::WsClient client;
+  std::string response;
+  EXPECT(client.ConnectTcp(server.port()));
+  EXPECT(client.Handshake("bench",
+                          "Sec-WebSocket-Extensions: permessage-deflate\r\n",
+                          &response));
+  z_stream deflater = z_stream();
+  z_stream inflater = z_stream();
+  deflateInit2(&deflater, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+  inflateInit2(&inflater, -15);
+
+  std::mt19937 rng(1);
+  for (int i = 0; i < 500; i++) {
+    std::string message = RandomText(&rng, rng() % 5000);
+    bool compress = rng() % 2 != 0;
+    std::string payload = compress ? Deflate(&deflater, message) : message;
+    size_t fragments = 1 + rng() % 5;
+    size_t offset = 0;
+    for (size_t f = 0; f < fragments; f++) {
+      bool last = f + 1 == fragments;
+      size_t length = last ? payload.size() - offset
+                           : rng() % (payload.size() - offset + 1);
+      // RSV1 is only set on the first fragment of a compressed message.
+      EXPECT(client.SendFrame(payload.substr(offset, length),
+                              f == 0 ? kOpCodeText : kOpCodeContinuation,
+                              last, compress && f == 0));
+      offset += length;
+      if (!last && rng() % 3 == 0)
+        EXPECT(client.SendFrame("ping", kOpCodePing));
+    }
+    uint8_t first_byte;
+    std::string echo;
+    EXPECT(ReadMessage(&client, &first_byte, &echo));
+    EXPECT((first_byte & 0x0f) == kOpCodeText && (first_byte & kFin) != 0);
+    if (first_byte & kRsv1)
+      echo = Inflate(&inflater, echo);
+    // Only messages over deflate_threshold go out compressed.
+    EXPECT(((first_byte & kRsv1) != 0) == (message.size() >= 64));
+    EXPECT(echo == message);
+  }
+  deflateEnd(&deflater);
+  inflateEnd(&inflater);
+  client.Close();
+
+  // A continuation without a first fragment fails the connection, with or
+  // without a close frame.
+  bench::WsClient broken;
+  EXPECT(broken.ConnectTcp(server.port()));
+  EXPECT(broken.Handshake("bench", "", &response));
+  EXPECT(broken.SendFrame("oops", kOpCodeContinuation));
+  uint8_t first_byte;
+  std::string echo;
+  EXPECT(!broken.ReadFrame(&first_byte, &echo) || first_byte == 0x88);
+  broken.Close();
+  server.Stop();
+}
+
+}  // namespace
+
+int main() {
+  CheckNegotiation();
+  CheckFragments();
+  return bench::TestResult("test_websocket");
+}
@@ -0,0 +1,212 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+#ifndef BENCH_WS_CLIENT_H_
+#define BENCH_WS_CLIENT_H_
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <string>
+
+namespace bench {
+
+// Minimal blocking WebSocket client for driving the server from a test or
+// benchmark thread. Frames are always sent masked, as RFC 6455 requires of
+// clients.
+class WsClient {
+ public:
+  WsClient() : fd_(-1) { }
+  ~WsClient() { Close(); }
+
+  bool ConnectTcp(int port) {
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd_ < 0)
+      return false;
+    int one = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    SetTimeout();
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return connect(fd_, reinterpret_cast<sockaddr*>(&addr),
+                   sizeof(addr)) == 0;
+  }
+
+  // A path starting with '@' names a socket in the Linux abstract namespace.
+  bool ConnectUnix(const std::string& path) {
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0 || path.size() >= sizeof(sockaddr_un().sun_path))
+      return false;
+    SetTimeout();
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.data(), path.size());
+    if (path[0] == '@')
+      addr.sun_path[0] = '\0';
+    socklen_t len = offsetof(sockaddr_un, sun_path) + path.size();
+    return connect(fd_, reinterpret_cast<sockaddr*>(&addr), len) == 0;
+  }
+
+  // Sends a request head and reads the response head.
+  bool Request(const std::string& head, std::string* response) {
+    return SendRaw(head.data(), head.size()) && ReadHead(response);
+  }
+
+  // Reads a response head, up to and including the empty line.
+  bool ReadHead(std::string* response) {
+    response->clear();
+    char c;
+    while (response->size() < 4 ||
+           response->compare(response->size() - 4, 4, "\r\n\r\n") != 0) {
+      if (!ReadExact(&c, 1))
+        return false;
+      response->push_back(c);
+    }
+    return true;
+  }
+
+  // Upgrades to a WebSocket session with target. extra_headers are
+  // complete "Name: value\r\n" lines. Returns false unless the server
+  // answered 101.
+  bool Handshake(const std::string& target, const std::string& extra_headers,
+                 std::string* response) {
+    std::string head = "GET /" + target + " HTTP/1.1\r\n"
+                       "Host: localhost\r\n"
+                       "Upgrade: websocket\r\n"
+                       "Connection: Upgrade\r\n"
+                       "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                       "Sec-WebSocket-Version: 13\r\n" +
+                       extra_headers + "\r\n";
+    return Request(head, response) &&
+           response->compare(0, 12, "HTTP/1.1 101") == 0;
+  }
+
+  bool SendFrame(const std::string& payload, uint8_t opcode = 1,
+                 bool fin = true, bool rsv1 = false) {
+    static const char kMaskingKey[] = {'\x12', '\x34', '\x56', '\x78'};
+    std::string frame;
+    frame.reserve(payload.size() + 14);
+    frame.push_back(static_cast<char>((fin ? 0x80 : 0) | (rsv1 ? 0x40 : 0) |
+                                      opcode));
+    size_t length = payload.size();
+    if (length < 126) {
+      frame.push_back(static_cast<char>(0x80 | length));
+    } else if (length <= 0xffff) {
+      frame.push_back(static_cast<char>(0x80 | 126));
+      frame.push_back(static_cast<char>(length >> 8));
+      frame.push_back(static_cast<char>(length & 0xff));
+    } else {
+      frame.push_back(static_cast<char>(0x80 | 127));
+      for (int shift = 56; shift >= 0; shift -= 8)
+        frame.push_back(static_cast<char>((length >> shift) & 0xff));
+    }
+    frame.append(kMaskingKey, sizeof(kMaskingKey));
+    for (size_t i = 0; i < length; i++)
+      frame.push_back(payload[i] ^ kMaskingKey[i % 4]);
+    return SendRaw(frame.data(), frame.size());
+  }
+
+  // Reads one frame, first_byte gets FIN, RSV and the opcode.
+  bool ReadFrame(uint8_t* first_byte, std::string* payload) {
+    unsigned char head[2];
+    if (!ReadExact(reinterpret_cast<char*>(head), 2))
+      return false;
+    *first_byte = head[0];
+    uint64_t length = head[1] & 0x7f;
+    int extended = length == 126 ? 2 : length == 127 ? 8 : 0;
+    if (extended > 0) {
+      unsigned char bytes[8];
+      if (!ReadExact(reinterpret_cast<char*>(bytes), extended))
+        return false;
+      length = 0;
+      for (int i = 0; i < extended; i++)
+        length = length << 8 | bytes[i];
+    }
+    payload->resize(length);
+    return length == 0 || ReadExact(&(*payload)[0], length);
+  }
+
+  bool SendRaw(const char* data, size_t length) {
+    while (length > 0) {
+      ssize_t sent = send(fd_, data, length, 0);
+      if (sent <= 0)
+        return false;
+      data += sent;
+      length -= sent;
+    }
+    return true;
+  }
+
+  // Reads until the server closes the connection.
+  bool ReadToEnd(std::string* data) {
+    char buffer[4096];
+    for (;;) {
+      ssize_t got = recv(fd_, buffer, sizeof(buffer), 0);
+      if (got < 0)
+        return false;
+      if (got == 0)
+        return true;
+      data->append(buffer, got);
+    }
+  }
+
+  bool ReadExact(char* data, size_t length) {
+    while (length > 0) {
+      ssize_t got = recv(fd_, data, length, 0);
+      if (got <= 0)
+        return false;
+      data += got;
+      length -= got;
+    }
+    return true;
+  }
+
+  void Close() {
+    if (fd_ >= 0)
+      close(fd_);
+    fd_ = -1;
+  }
+
+ private:
+  // Reads fail rather than block forever if the server never answers.
+  void SetTimeout() {
+    timeval timeout = {5, 0};
+    setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  }
+
+  int fd_;
+};
+
+}  // namespace bench
+
+#endif  // BENCH_WS_CLIENT_H_
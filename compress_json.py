@@ -20,6 +20,7 @@
 # FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 # IN THE SOFTWARE.
 
+import collections
 import json
 import struct
 import sys
@@ -27,18 +28,23 @@ import zlib
 
 if __name__ == '__main__':
   fp = open(sys.argv[1])
-  obj = json.load(fp)
-  text = json.dumps(obj, separators=(',', ':'))
+  # Keep the order of the source file whatever the Python version.
+  obj = json.load(fp, object_pairs_hook=collections.OrderedDict)
+  text = json.dumps(obj, separators=(',', ':')).encode('utf-8')
   data = zlib.compress(text, zlib.Z_BEST_COMPRESSION)
 
   # To make decompression a little easier, we prepend the compressed data
   # with the size of the uncompressed data as a 24 bits BE unsigned integer.
+  # Its CRC-32 follows as a 32 bits BE unsigned integer, which lets the
+  # server wrap the deflate stream as gzip without inflating it.
   assert len(text) < 1 << 24, 'Uncompressed JSON must be < 16 MB.'
-  data = struct.pack('>I', len(text))[1:4] + data
+  data = (struct.pack('>I', len(text))[1:4] +
+          struct.pack('>I', zlib.crc32(text) & 0xffffffff) + data)
 
   step = 20
-  slices = (data[i:i+step] for i in xrange(0, len(data), step))
-  slices = map(lambda s: ','.join(str(ord(c)) for c in s), slices)
+  data = bytearray(data)
+  slices = (data[i:i+step] for i in range(0, len(data), step))
+  slices = map(lambda s: ','.join(str(c) for c in s), slices)
   text = ',\n'.join(slices)
 
   fp = open(sys.argv[2], 'w')
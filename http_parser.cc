@@ -29,6 +29,30 @@
 #include <limits.h>
 #include <cassert>
 
+/* Header names and values are scanned a vector at a time where the target
+ * supports it, in the spirit of picohttpparser. SSE4.2 string compares need
+ * -msse4.2 (implied by -mavx2); SSE2 is always available on x64.
+ */
+#if defined(__AVX2__)
+# include <immintrin.h>
+# define HTTP_SCAN_VECTOR_WIDTH 32
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define HTTP_SCAN_VECTOR_WIDTH 16
+#else
+# define HTTP_SCAN_VECTOR_WIDTH 0
+#endif
+#if defined(__SSE4_2__) && !defined(__AVX2__)
+# include <nmmintrin.h>
+# define HTTP_SCAN_SSE42 1
+#else
+# define HTTP_SCAN_SSE42 0
+#endif
+#if HTTP_SCAN_VECTOR_WIDTH && defined(_MSC_VER)
+# include <intrin.h>
+#endif
+
 #ifndef ULLONG_MAX
 # define ULLONG_MAX ((uint64_t) -1) /* 2^64-1 */
 #endif
@@ -445,6 +469,130 @@ enum http_host_state
 #define start_state (parser->type == HTTP_REQUEST ? s_start_req : s_start_res)
 
 
+#if HTTP_SCAN_VECTOR_WIDTH
+static inline unsigned
+first_set_bit(unsigned mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (unsigned) index;
+#else
+  return (unsigned) __builtin_ctz(mask);
+#endif
+}
+#endif
+
+/* Returns the first byte in [p, end) that is not a token character, or end.
+ * The vector paths may stop early on a few token characters ('{' to '~');
+ * callers re-check the byte they stop at, so that only costs a rescan.
+ */
+static const char *
+scan_token(const char *p, const char *end) {
+#if HTTP_SCAN_VECTOR_WIDTH == 32
+  /* Nibble lookup: a byte is a token character iff the bit for its high
+   * nibble is set in the entry for its low nibble. Bytes >= 0x80 never are.
+   */
+  const __m256i lo_table = _mm256_setr_epi8(
+      (char) 0xe8, (char) 0xfc, (char) 0xf8, (char) 0xfc,
+      (char) 0xfc, (char) 0xfc, (char) 0xfc, (char) 0xfc,
+      (char) 0xf8, (char) 0xf8, (char) 0xf4, (char) 0x54,
+      (char) 0xd0, (char) 0x54, (char) 0xf4, (char) 0x70,
+      (char) 0xe8, (char) 0xfc, (char) 0xf8, (char) 0xfc,
+      (char) 0xfc, (char) 0xfc, (char) 0xfc, (char) 0xfc,
+      (char) 0xf8, (char) 0xf8, (char) 0xf4, (char) 0x54,
+      (char) 0xd0, (char) 0x54, (char) 0xf4, (char) 0x70);
+  const __m256i hi_table = _mm256_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, (char) 128, 0, 0, 0, 0, 0, 0, 0, 0,
+      1, 2, 4, 8, 16, 32, 64, (char) 128, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  const __m256i zero = _mm256_setzero_si256();
+  for (; end - p >= 32; p += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *) p);
+    __m256i lo = _mm256_shuffle_epi8(lo_table, _mm256_and_si256(v, nibble));
+    __m256i hi = _mm256_shuffle_epi8(hi_table,
+        _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+    unsigned mask = (unsigned) _mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), zero));
+    if (mask != 0)
+      return p + first_set_bit(mask);
+  }
+#elif HTTP_SCAN_SSE42
+  static const char ranges[] = "\x00 \"\"(),,//:@[]{\xff";
+  const __m128i r = _mm_loadu_si128((const __m128i *) ranges);
+  for (; end - p >= 16; p += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *) p);
+    int index = _mm_cmpestri(r, sizeof(ranges) - 1, v, 16, _SIDD_UBYTE_OPS |
+                             _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+    if (index != 16)
+      return p + index;
+  }
+#endif
+  for (; p != end; p++) {
+    if (!tokens[(unsigned char) *p])
+      break;
+  }
+  return p;
+}
+
+/* Returns the first CR or LF in [p, end), or end. With stop_at_ctl the scan
+ * also stops at any other control character except HT.
+ */
+static inline const char *
+scan_value(const char *p, const char *end, int stop_at_ctl) {
+#if HTTP_SCAN_VECTOR_WIDTH == 32
+  const __m256i cr = _mm256_set1_epi8(CR);
+  const __m256i lf = _mm256_set1_epi8(LF);
+  const __m256i ht = _mm256_set1_epi8(9);
+  const __m256i us = _mm256_set1_epi8(31);
+  const __m256i del = _mm256_set1_epi8(127);
+  for (; end - p >= 32; p += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *) p);
+    __m256i stop;
+    if (stop_at_ctl) {
+      __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, us), v);
+      stop = _mm256_or_si256(
+          _mm256_andnot_si256(_mm256_cmpeq_epi8(v, ht), ctl),
+          _mm256_cmpeq_epi8(v, del));
+    } else {
+      stop = _mm256_or_si256(_mm256_cmpeq_epi8(v, cr),
+                             _mm256_cmpeq_epi8(v, lf));
+    }
+    unsigned mask = (unsigned) _mm256_movemask_epi8(stop);
+    if (mask != 0)
+      return p + first_set_bit(mask);
+  }
+#elif HTTP_SCAN_VECTOR_WIDTH == 16
+  const __m128i cr = _mm_set1_epi8(CR);
+  const __m128i lf = _mm_set1_epi8(LF);
+  const __m128i ht = _mm_set1_epi8(9);
+  const __m128i us = _mm_set1_epi8(31);
+  const __m128i del = _mm_set1_epi8(127);
+  for (; end - p >= 16; p += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *) p);
+    __m128i stop;
+    if (stop_at_ctl) {
+      __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(v, us), v);
+      stop = _mm_or_si128(_mm_andnot_si128(_mm_cmpeq_epi8(v, ht), ctl),
+                          _mm_cmpeq_epi8(v, del));
+    } else {
+      stop = _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf));
+    }
+    unsigned mask = (unsigned) _mm_movemask_epi8(stop);
+    if (mask != 0)
+      return p + first_set_bit(mask);
+  }
+#endif
+  for (; p != end; p++) {
+    unsigned char ch = (unsigned char) *p;
+    if (ch == CR || ch == LF)
+      break;
+    if (stop_at_ctl && ((ch < 32 && ch != 9) || ch == 127))
+      break;
+  }
+  return p;
+}
+
+
 #if HTTP_PARSER_STRICT
 # define STRICT_CHECK(cond)                                          \
 do {                                                                 \
@@ -1307,6 +1455,8 @@ reexecute:
 
           switch (parser->header_state) {
             case h_general:
+              /* Nothing left to match; skip the rest of the name at once. */
+              p = scan_token(p + 1, data + len) - 1;
               break;
 
             case h_C:
@@ -1533,24 +1683,12 @@ reexecute:
           switch (h_state) {
             case h_general:
             {
-              const char* p_cr;
-              const char* p_lf;
               size_t limit = data + len - p;
 
               limit = MIN(limit, HTTP_MAX_HEADER_SIZE);
 
-              p_cr = (const char*) memchr(p, CR, limit);
-              p_lf = (const char*) memchr(p, LF, limit);
-              if (p_cr != NULL) {
-                if (p_lf != NULL && p_cr >= p_lf)
-                  p = p_lf;
-                else
-                  p = p_cr;
-              } else if (UNLIKELY(p_lf != NULL)) {
-                p = p_lf;
-              } else {
-                p = data + len;
-              }
+              /* One pass for both terminators instead of memchr twice. */
+              p = scan_value(p, p + limit, 0);
               --p;
 
               break;
@@ -2460,6 +2598,28 @@ http_body_is_final(const struct http_parser *parser) {
     return parser->state == s_message_done;
 }
 
+int
+http_parser_at_message_start(const http_parser *parser) {
+  return parser->state == s_start_req ||
+         parser->state == s_start_res ||
+         parser->state == s_start_req_or_res;
+}
+
+const char *
+http_scan_token(const char *p, const char *end) {
+  for (;;) {
+    p = scan_token(p, end);
+    if (p == end || !tokens[(unsigned char) *p])
+      return p;
+    p++;
+  }
+}
+
+const char *
+http_scan_header_value(const char *p, const char *end) {
+  return scan_value(p, end, 1);
+}
+
 unsigned long
 http_parser_version(void) {
   return HTTP_PARSER_VERSION_MAJOR * 0x10000 |
@@ -356,6 +356,20 @@ void http_parser_pause(http_parser *parser, int paused);
 /* Checks if this is the final chunk of the body. */
 int http_body_is_final(const http_parser *parser);
 
+/* Checks if the parser is between messages, i.e. holds no partial request
+ * or response. */
+int http_parser_at_message_start(const http_parser *parser);
+
+/* Vectorized scanners used by the parser, for callers that pre-scan a
+ * request head themselves. Both return `end` if nothing stops the scan.
+ */
+
+/* Returns the first byte that is not a header token character. */
+const char *http_scan_token(const char *p, const char *end);
+
+/* Returns the first CR, LF or other control character except HT. */
+const char *http_scan_header_value(const char *p, const char *end);
+
 #ifdef __cplusplus
 }
 #endif
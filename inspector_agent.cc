@@ -44,9 +44,6 @@ namespace inspector {
 FILE *gLogStream = stderr;
 
 std::string GenerateID();
-std::string MakeFrontEndURL(const std::string& host,
-                            int port,
-                            const std::string& id);
 namespace {
 using namespace v8;
 
@@ -276,6 +273,10 @@ Agent::~Agent() {
 
 void Agent::SetLogFileStream(FILE *file) {gLogStream = file;}
 
+void Agent::SetOptions(const InspectorOptions& options) {
+  options_ = options;
+}
+
 bool Agent::IsValid() {
     if(magic_ != VALID_MAGIC)
         fprintf(gLogStream, "v8inspector: Invalid agent at 0X%p - magic = %08X\n", this, magic_);
@@ -283,9 +284,18 @@ bool Agent::IsValid() {
 }
 
 
+std::shared_future<std::string> Agent::GetFrontendURLAsync() {
+  if (io_ == nullptr) {
+    std::promise<std::string> not_started;
+    not_started.set_value(std::string());
+    return not_started.get_future().share();
+  }
+  return io_->frontend_url();
+}
+
 const std::string &Agent::GetFrontendURL()
 {
-    frontend_url_buff_ = MakeFrontEndURL(host_name_, io_->port(), target_id_);
+    frontend_url_buff_ = GetFrontendURLAsync().get();
     return frontend_url_buff_;
 }
 
@@ -298,14 +308,17 @@ bool Agent::Prepare(Isolate *isolate, Platform* platform, const char* path) {
           new CBInspectorClient(isolate_, platform));
   client_->contextCreated(isolate_->GetCurrentContext(), "CB debugger context");
   platform_ = platform;
-  assert(0 == uv_async_init(uv_default_loop(),
-                            &start_io_thread_async,
-                            StartIoThreadAsyncCallback));
+  int err = uv_async_init(uv_default_loop(), &start_io_thread_async,
+                          StartIoThreadAsyncCallback);
+  assert(err == 0);
+  (void) err;
   start_io_thread_async.data = this;
   uv_unref(reinterpret_cast<uv_handle_t*>(&start_io_thread_async));
 
   if (true) {
-    // This will return false if listen failed on the inspector port.
+    // The server starts on the IO thread, this only fails if the thread
+    // cannot be created. A failure to listen shows in GetFrontendURLAsync()
+    // and Run().
     return StartIoThread(true);
   }
   return true;
@@ -319,8 +332,9 @@ bool Agent::StartIoThread(bool wait_for_connect) {
 
   enabled_ = true;
   io_ = std::unique_ptr<InspectorIo>(
-      new InspectorIo(isolate_, platform_, path_, host_name_, true, file_path_, this, target_id_));
-  return true;
+      new InspectorIo(isolate_, platform_, path_, host_name_, true, file_path_, this, target_id_,
+                      options_));
+  return io_->Launch();
 }
 bool Agent::Run() {
 
@@ -339,6 +353,17 @@ void Agent::Stop() {
   }
 }
 
+void Agent::AddTarget(const std::string& id, const std::string& title,
+                      const std::string& url) {
+  if (io_ != nullptr)
+    io_->AddTarget(id, title, url);
+}
+
+void Agent::RemoveTarget(const std::string& id) {
+  if (io_ != nullptr)
+    io_->RemoveTarget(id);
+}
+
 void Agent::Connect(InspectorSessionDelegate* delegate) {
   enabled_ = true;
   client_->connectFrontend(delegate);
@@ -26,8 +26,10 @@
 #include <memory>
 #include <string>
 #include <functional>
+#include <future>
 #include "v8.h"
 #include "v8-inspector.h"
+#include "inspector_options.h"
 
 #include <stddef.h>
 
@@ -70,11 +72,23 @@ class Agent {
     return Run();
   }
 
+  // Must be called before Prepare() to take effect.
+  EXPORT_ATTRIBUTE  void SetOptions(const InspectorOptions& options);
   EXPORT_ATTRIBUTE  bool Prepare(Isolate* isolate, Platform* platform, const char* file_path = nullptr);
   EXPORT_ATTRIBUTE  bool Run();
+  // Prepare() leaves resolving, listening and writing the URL file to the
+  // IO thread. The future is ready once that is done, with the URL or empty
+  // on failure; GetFrontendURL() waits for it.
+  EXPORT_ATTRIBUTE  std::shared_future<std::string> GetFrontendURLAsync();
   EXPORT_ATTRIBUTE  const std::string &GetFrontendURL();
   // Stop and destroy io_
   EXPORT_ATTRIBUTE  void Stop();
+  // Announce or withdraw a target besides target_id in /json/list, once
+  // Prepare() created io_. Main thread only.
+  EXPORT_ATTRIBUTE  void AddTarget(const std::string& id,
+                                   const std::string& title,
+                                   const std::string& url);
+  EXPORT_ATTRIBUTE  void RemoveTarget(const std::string& id);
 
   bool IsStarted() { return !!client_; }
   bool IsValid();
@@ -125,6 +139,7 @@ class Agent {
   std::string host_name_;
   std::string file_path_;
   std::string target_id_;
+  InspectorOptions options_;
 
   std::string frontend_url_buff_;
   static const int VALID_MAGIC = 0xF0F0F0F0;
@@ -0,0 +1,600 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+
+#include "inspector_cbor.h"
+#include "base64.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace inspector {
+
+namespace {
+
+// Protocol messages are shallow, this only guards the stack.
+const int kMaxDepth = 300;
+
+const uint8_t kMajorUnsigned = 0;
+const uint8_t kMajorNegative = 1;
+const uint8_t kMajorBytes = 2;
+const uint8_t kMajorText = 3;
+const uint8_t kMajorArray = 4;
+const uint8_t kMajorMap = 5;
+const uint8_t kMajorTag = 6;
+const uint8_t kMajorSimple = 7;
+
+const uint8_t kIndefiniteLength = 31;
+const uint8_t kFalse = 0xf4;
+const uint8_t kTrue = 0xf5;
+const uint8_t kNull = 0xf6;
+const uint8_t kDouble = 0xfb;
+const uint8_t kBreak = 0xff;
+// Tag for "encoded CBOR data item", wraps whole messages.
+const uint64_t kTagEnvelope = 24;
+
+void WriteHead(uint8_t major, uint64_t value, std::string* out) {
+  uint8_t initial = major << 5;
+  int bytes;
+  if (value < 24) {
+    out->push_back(static_cast<char>(initial | value));
+    return;
+  } else if (value <= 0xff) {
+    out->push_back(static_cast<char>(initial | 24));
+    bytes = 1;
+  } else if (value <= 0xffff) {
+    out->push_back(static_cast<char>(initial | 25));
+    bytes = 2;
+  } else if (value <= 0xffffffff) {
+    out->push_back(static_cast<char>(initial | 26));
+    bytes = 4;
+  } else {
+    out->push_back(static_cast<char>(initial | 27));
+    bytes = 8;
+  }
+  for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8)
+    out->push_back(static_cast<char>((value >> shift) & 0xff));
+}
+
+void WriteDouble(double value, std::string* out) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  out->push_back(static_cast<char>(kDouble));
+  for (int shift = 56; shift >= 0; shift -= 8)
+    out->push_back(static_cast<char>((bits >> shift) & 0xff));
+}
+
+void AppendUtf8(uint32_t code_point, std::string* out) {
+  if (code_point < 0x80) {
+    out->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out->push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  } else if (code_point < 0x10000) {
+    out->push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  } else {
+    out->push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  }
+}
+
+class JsonReader {
+ public:
+  JsonReader(const char* json, size_t length, std::string* out)
+      : pos_(json), end_(json + length), out_(out) { }
+
+  bool Run() {
+    SkipWhitespace();
+    if (!ParseValue(0))
+      return false;
+    SkipWhitespace();
+    return pos_ == end_;
+  }
+
+ private:
+  void SkipWhitespace() {
+    while (pos_ < end_ &&
+           (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\n' || *pos_ == '\r'))
+      pos_++;
+  }
+
+  bool Consume(const char* literal) {
+    size_t length = strlen(literal);
+    if (static_cast<size_t>(end_ - pos_) < length ||
+        memcmp(pos_, literal, length) != 0)
+      return false;
+    pos_ += length;
+    return true;
+  }
+
+  bool ParseValue(int depth) {
+    if (pos_ == end_ || depth > kMaxDepth)
+      return false;
+    switch (*pos_) {
+    case '{':
+      return ParseObject(depth);
+    case '[':
+      return ParseArray(depth);
+    case '"':
+      return ParseString();
+    case 't':
+      out_->push_back(static_cast<char>(kTrue));
+      return Consume("true");
+    case 'f':
+      out_->push_back(static_cast<char>(kFalse));
+      return Consume("false");
+    case 'n':
+      out_->push_back(static_cast<char>(kNull));
+      return Consume("null");
+    default:
+      return ParseNumber();
+    }
+  }
+
+  bool ParseObject(int depth) {
+    pos_++;
+    out_->push_back(static_cast<char>((kMajorMap << 5) | kIndefiniteLength));
+    SkipWhitespace();
+    if (pos_ < end_ && *pos_ == '}') {
+      pos_++;
+      out_->push_back(static_cast<char>(kBreak));
+      return true;
+    }
+    for (;;) {
+      SkipWhitespace();
+      if (pos_ == end_ || *pos_ != '"' || !ParseString())
+        return false;
+      SkipWhitespace();
+      if (pos_ == end_ || *pos_++ != ':')
+        return false;
+      SkipWhitespace();
+      if (!ParseValue(depth + 1))
+        return false;
+      SkipWhitespace();
+      if (pos_ == end_)
+        return false;
+      char c = *pos_++;
+      if (c == '}')
+        break;
+      if (c != ',')
+        return false;
+    }
+    out_->push_back(static_cast<char>(kBreak));
+    return true;
+  }
+
+  bool ParseArray(int depth) {
+    pos_++;
+    out_->push_back(static_cast<char>((kMajorArray << 5) | kIndefiniteLength));
+    SkipWhitespace();
+    if (pos_ < end_ && *pos_ == ']') {
+      pos_++;
+      out_->push_back(static_cast<char>(kBreak));
+      return true;
+    }
+    for (;;) {
+      SkipWhitespace();
+      if (!ParseValue(depth + 1))
+        return false;
+      SkipWhitespace();
+      if (pos_ == end_)
+        return false;
+      char c = *pos_++;
+      if (c == ']')
+        break;
+      if (c != ',')
+        return false;
+    }
+    out_->push_back(static_cast<char>(kBreak));
+    return true;
+  }
+
+  bool ParseHex4(uint32_t* value) {
+    if (end_ - pos_ < 4)
+      return false;
+    uint32_t result = 0;
+    for (int i = 0; i < 4; i++) {
+      char c = *pos_++;
+      result <<= 4;
+      if (c >= '0' && c <= '9')
+        result |= c - '0';
+      else if (c >= 'a' && c <= 'f')
+        result |= c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F')
+        result |= c - 'A' + 10;
+      else
+        return false;
+    }
+    *value = result;
+    return true;
+  }
+
+  bool ParseString() {
+    pos_++;
+    std::string text;
+    for (;;) {
+      // Copy runs without escapes in one go.
+      const char* run = pos_;
+      while (pos_ < end_ && *pos_ != '"' && *pos_ != '\\' &&
+             static_cast<unsigned char>(*pos_) >= 0x20)
+        pos_++;
+      text.append(run, pos_ - run);
+      if (pos_ == end_ || static_cast<unsigned char>(*pos_) < 0x20)
+        return false;
+      if (*pos_++ == '"')
+        break;
+      if (pos_ == end_)
+        return false;
+      char escape = *pos_++;
+      switch (escape) {
+      case '"': text.push_back('"'); break;
+      case '\\': text.push_back('\\'); break;
+      case '/': text.push_back('/'); break;
+      case 'b': text.push_back('\b'); break;
+      case 'f': text.push_back('\f'); break;
+      case 'n': text.push_back('\n'); break;
+      case 'r': text.push_back('\r'); break;
+      case 't': text.push_back('\t'); break;
+      case 'u': {
+        uint32_t code_point;
+        if (!ParseHex4(&code_point))
+          return false;
+        if (code_point >= 0xd800 && code_point < 0xdc00 &&
+            end_ - pos_ >= 6 && pos_[0] == '\\' && pos_[1] == 'u') {
+          const char* saved = pos_;
+          uint32_t low;
+          pos_ += 2;
+          if (ParseHex4(&low) && low >= 0xdc00 && low < 0xe000) {
+            code_point = 0x10000 + ((code_point - 0xd800) << 10) +
+                         (low - 0xdc00);
+          } else {
+            pos_ = saved;
+          }
+        }
+        // Lone surrogates are kept as their three byte form.
+        AppendUtf8(code_point, &text);
+        break;
+      }
+      default:
+        return false;
+      }
+    }
+    WriteHead(kMajorText, text.size(), out_);
+    out_->append(text);
+    return true;
+  }
+
+  bool ParseNumber() {
+    const char* start = pos_;
+    bool integral = true;
+    if (pos_ < end_ && *pos_ == '-')
+      pos_++;
+    if (pos_ == end_ || *pos_ < '0' || *pos_ > '9')
+      return false;
+    while (pos_ < end_) {
+      char c = *pos_;
+      if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+        integral = false;
+      } else if (c < '0' || c > '9') {
+        break;
+      }
+      pos_++;
+    }
+    std::string number(start, pos_ - start);
+    char* number_end;
+    errno = 0;
+    if (integral) {
+      long long value = strtoll(number.c_str(), &number_end, 10);
+      if (errno == 0 && *number_end == '\0') {
+        if (value < 0)
+          WriteHead(kMajorNegative, static_cast<uint64_t>(-(value + 1)), out_);
+        else
+          WriteHead(kMajorUnsigned, static_cast<uint64_t>(value), out_);
+        return true;
+      }
+      errno = 0;
+    }
+    double value = strtod(number.c_str(), &number_end);
+    if (*number_end != '\0')
+      return false;
+    WriteDouble(value, out_);
+    return true;
+  }
+
+  const char* pos_;
+  const char* const end_;
+  std::string* const out_;
+};
+
+double DecodeHalf(uint16_t half) {
+  int exponent = (half >> 10) & 0x1f;
+  int mantissa = half & 0x3ff;
+  double value;
+  if (exponent == 0)
+    value = ldexp(mantissa, -24);
+  else if (exponent != 31)
+    value = ldexp(mantissa + 1024, exponent - 25);
+  else
+    value = mantissa == 0 ? INFINITY : NAN;
+  return (half & 0x8000) ? -value : value;
+}
+
+void AppendNumber(double value, std::string* out) {
+  if (!isfinite(value)) {
+    out->append("null");
+    return;
+  }
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.15g", value);
+  if (strtod(buffer, nullptr) != value)
+    snprintf(buffer, sizeof(buffer), "%.17g", value);
+  out->append(buffer);
+}
+
+void AppendEscaped(const char* text, size_t length, std::string* out) {
+  static const char kHex[] = "0123456789abcdef";
+  for (size_t i = 0; i < length; i++) {
+    unsigned char c = text[i];
+    switch (c) {
+    case '"': out->append("\\\""); break;
+    case '\\': out->append("\\\\"); break;
+    case '\b': out->append("\\b"); break;
+    case '\f': out->append("\\f"); break;
+    case '\n': out->append("\\n"); break;
+    case '\r': out->append("\\r"); break;
+    case '\t': out->append("\\t"); break;
+    default:
+      if (c < 0x20) {
+        out->append("\\u00");
+        out->push_back(kHex[c >> 4]);
+        out->push_back(kHex[c & 0xf]);
+      } else {
+        out->push_back(static_cast<char>(c));
+      }
+    }
+  }
+}
+
+class CborReader {
+ public:
+  CborReader(const char* cbor, size_t length, std::string* out)
+      : pos_(reinterpret_cast<const uint8_t*>(cbor)),
+        end_(reinterpret_cast<const uint8_t*>(cbor) + length), out_(out) { }
+
+  bool Run() {
+    return ParseValue(0) && pos_ == end_;
+  }
+
+ private:
+  size_t remaining() const { return end_ - pos_; }
+
+  // Reads the argument following an initial byte. Sets *indefinite instead
+  // for additional information 31.
+  bool ReadArgument(uint8_t additional, uint64_t* value, bool* indefinite) {
+    *indefinite = false;
+    if (additional < 24) {
+      *value = additional;
+      return true;
+    }
+    if (additional == kIndefiniteLength) {
+      *indefinite = true;
+      return true;
+    }
+    if (additional > 27)
+      return false;
+    size_t bytes = static_cast<size_t>(1) << (additional - 24);
+    if (remaining() < bytes)
+      return false;
+    uint64_t result = 0;
+    for (size_t i = 0; i < bytes; i++)
+      result = (result << 8) | *pos_++;
+    *value = result;
+    return true;
+  }
+
+  // Definite or chunked string contents of the given major type.
+  bool ReadString(uint8_t major, uint8_t additional, std::string* text) {
+    uint64_t length;
+    bool indefinite;
+    if (!ReadArgument(additional, &length, &indefinite))
+      return false;
+    if (!indefinite) {
+      if (length > remaining())
+        return false;
+      text->append(reinterpret_cast<const char*>(pos_), length);
+      pos_ += length;
+      return true;
+    }
+    for (;;) {
+      if (pos_ == end_)
+        return false;
+      uint8_t initial = *pos_++;
+      if (initial == kBreak)
+        return true;
+      // Chunks must be definite strings of the same type.
+      if ((initial >> 5) != major || (initial & 0x1f) == kIndefiniteLength ||
+          !ReadString(major, initial & 0x1f, text))
+        return false;
+    }
+  }
+
+  bool AtBreak() {
+    if (pos_ < end_ && *pos_ == kBreak) {
+      pos_++;
+      return true;
+    }
+    return false;
+  }
+
+  bool ParseValue(int depth) {
+    if (pos_ == end_ || depth > kMaxDepth)
+      return false;
+    uint8_t initial = *pos_++;
+    uint8_t major = initial >> 5;
+    uint8_t additional = initial & 0x1f;
+    uint64_t value = 0;
+    bool indefinite = false;
+    switch (major) {
+    case kMajorUnsigned:
+    case kMajorNegative:
+      if (!ReadArgument(additional, &value, &indefinite) || indefinite)
+        return false;
+      if (major == kMajorUnsigned) {
+        out_->append(std::to_string(value));
+      } else if (value == UINT64_MAX) {
+        out_->append("-18446744073709551616");
+      } else {
+        out_->push_back('-');
+        out_->append(std::to_string(value + 1));
+      }
+      return true;
+    case kMajorBytes:
+    case kMajorText: {
+      std::string text;
+      if (!ReadString(major, additional, &text))
+        return false;
+      out_->push_back('"');
+      if (major == kMajorText) {
+        AppendEscaped(text.data(), text.size(), out_);
+      } else {
+        std::string encoded(base64_encoded_size(text.size()), '\0');
+        base64_encode(text.data(), text.size(), &encoded[0], encoded.size());
+        out_->append(encoded);
+      }
+      out_->push_back('"');
+      return true;
+    }
+    case kMajorArray:
+    case kMajorMap: {
+      if (!ReadArgument(additional, &value, &indefinite))
+        return false;
+      // Every item takes at least a byte.
+      if (!indefinite && value > remaining())
+        return false;
+      bool map = major == kMajorMap;
+      out_->push_back(map ? '{' : '[');
+      for (uint64_t i = 0; indefinite ? !AtBreak() : i < value; i++) {
+        if (i > 0)
+          out_->push_back(',');
+        if (map) {
+          // Keys have to be text to be valid JSON.
+          if (pos_ == end_ || (*pos_ >> 5) != kMajorText ||
+              !ParseValue(depth + 1))
+            return false;
+          out_->push_back(':');
+        }
+        if (!ParseValue(depth + 1))
+          return false;
+      }
+      out_->push_back(map ? '}' : ']');
+      return true;
+    }
+    case kMajorTag:
+      if (!ReadArgument(additional, &value, &indefinite) || indefinite)
+        return false;
+      if (value == kTagEnvelope && pos_ < end_ &&
+          (*pos_ >> 5) == kMajorBytes) {
+        // The embedded item is parsed where it is, one level down, and
+        // must fill the byte string exactly. Only a definite byte string
+        // can be read in place.
+        uint8_t bytes_initial = *pos_++;
+        uint64_t length = 0;
+        if (!ReadArgument(bytes_initial & 0x1f, &length, &indefinite) ||
+            indefinite || length > remaining())
+          return false;
+        const uint8_t* outer_end = end_;
+        end_ = pos_ + length;
+        bool parsed = ParseValue(depth + 1) && pos_ == end_;
+        end_ = outer_end;
+        return parsed;
+      }
+      // Other tags carry no meaning for JSON, only the tagged item does.
+      return ParseValue(depth + 1);
+    case kMajorSimple:
+      switch (initial) {
+      case kFalse:
+        out_->append("false");
+        return true;
+      case kTrue:
+        out_->append("true");
+        return true;
+      case kNull:
+      case 0xf7:  // undefined
+        out_->append("null");
+        return true;
+      case 0xf9:
+      case 0xfa:
+      case kDouble: {
+        if (!ReadArgument(additional, &value, &indefinite))
+          return false;
+        double number;
+        if (initial == 0xf9) {
+          number = DecodeHalf(static_cast<uint16_t>(value));
+        } else if (initial == 0xfa) {
+          uint32_t bits = static_cast<uint32_t>(value);
+          float single;
+          memcpy(&single, &bits, sizeof(single));
+          number = single;
+        } else {
+          memcpy(&number, &value, sizeof(number));
+        }
+        AppendNumber(number, out_);
+        return true;
+      }
+      default:
+        return false;
+      }
+    }
+    return false;
+  }
+
+  const uint8_t* pos_;
+  // Narrowed while parsing the item inside an envelope.
+  const uint8_t* end_;
+  std::string* const out_;
+};
+
+}  // namespace
+
+bool JsonToCbor(const char* json, size_t length, std::string* cbor) {
+  cbor->clear();
+  cbor->reserve(length);
+  JsonReader reader(json, length, cbor);
+  return reader.Run();
+}
+
+bool CborToJson(const char* cbor, size_t length, std::string* json) {
+  json->clear();
+  json->reserve(length + length / 2);
+  CborReader reader(cbor, length, json);
+  return reader.Run();
+}
+
+}  // namespace inspector
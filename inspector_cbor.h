@@ -0,0 +1,43 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+
+#ifndef SRC_INSPECTOR_CBOR_H_
+#define SRC_INSPECTOR_CBOR_H_
+
+#include <stddef.h>
+#include <string>
+
+namespace inspector {
+
+// Translation between the JSON text V8 speaks and CBOR (RFC 7049) binary
+// frames, done on the IO thread. Objects and arrays are written with
+// indefinite length, integral numbers as integers, everything else as
+// doubles. The reader also accepts definite lengths, byte strings (as
+// base64 text) and a tag 24 envelope around the message.
+// Both return false on malformed or too deeply nested input.
+bool JsonToCbor(const char* json, size_t length, std::string* cbor);
+bool CborToJson(const char* cbor, size_t length, std::string* json);
+
+}  // namespace inspector
+
+#endif  // SRC_INSPECTOR_CBOR_H_
@@ -21,17 +21,22 @@
 */
 
 #include "inspector_io.h"
+#include "inspector_loopback.h"
+#include "inspector_shm.h"
 #include "inspector_socket_server.h"
 #include "inspector_socket.h"
+#include "inspector_utf8.h"
 #include "inspector_agent.h"
 #include "v8-inspector.h"
 #include "v8-platform.h"
 #include "zlib.h"
 
 #include <sstream>
-#include <unicode/unistr.h>
 
 #include <string.h>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
 #include <vector>
 #include <openssl/rand.h>
 #include <cassert>
@@ -66,6 +71,10 @@ using v8_inspector::StringView;
 template<typename Transport>
 using TransportAndIo = std::pair<Transport*, InspectorIo*>;
 
+// The InspectorIo of each isolate on this thread, for the isolate call
+// hooks which get no data pointer.
+thread_local std::unordered_map<Isolate*, InspectorIo*> main_thread_ios;
+
 std::string GetProcessTitle() {
   char title[2048];
   int err = uv_get_process_title(title, sizeof(title));
@@ -93,31 +102,95 @@ std::string ScriptPath(uv_loop_t* loop, const std::string& script_name) {
   return script_path;
 }
 
+// 8-bit views hold Latin-1, which only matches UTF-8 while it is ASCII.
 std::string StringViewToUtf8(const StringView& view) {
+  std::string result;
   if (view.is8Bit()) {
-    return std::string(reinterpret_cast<const char*>(view.characters8()),
-                       view.length());
-  }
-  const uint16_t* source = view.characters16();
-  const UChar* unicodeSource = reinterpret_cast<const UChar*>(source);
-  static_assert(sizeof(*source) == sizeof(*unicodeSource),
-                "sizeof(*source) == sizeof(*unicodeSource)");
-
-  size_t result_length = view.length() * sizeof(*source);
-  std::string result(result_length, '\0');
-  UnicodeString utf16(unicodeSource, view.length());
-  // ICU components for std::string compatibility are not enabled in build...
-  bool done = false;
-  while (!done) {
-    CheckedArrayByteSink sink(&result[0], result_length);
-    utf16.toUTF8(sink);
-    result_length = sink.NumberOfBytesAppended();
-    result.resize(result_length);
-    done = !sink.Overflowed();
+    result.resize(Latin1ToUtf8Length(view.characters8(), view.length()));
+    Latin1ToUtf8(view.characters8(), view.length(), &result[0]);
+  } else {
+    result.resize(Utf16ToUtf8Length(view.characters16(), view.length()));
+    Utf16ToUtf8(view.characters16(), view.length(), &result[0]);
   }
   return result;
 }
 
+// Returns the method of a protocol notification, or an empty string for
+// responses. V8 serializes notifications with "method" as the first key.
+template <typename Char>
+std::string NotificationMethod(const Char* chars, size_t length) {
+  static const char kPrefix[] = "{\"method\":\"";
+  const size_t prefix_length = sizeof(kPrefix) - 1;
+  if (length < prefix_length)
+    return std::string();
+  for (size_t i = 0; i < prefix_length; i++) {
+    if (chars[i] != static_cast<Char>(kPrefix[i]))
+      return std::string();
+  }
+  std::string method;
+  for (size_t i = prefix_length; i < length && chars[i] != '"'; i++) {
+    if (chars[i] > 0x7f)
+      return std::string();
+    method.push_back(static_cast<char>(chars[i]));
+  }
+  return method;
+}
+
+std::string NotificationMethod(const StringView& view) {
+  if (view.is8Bit())
+    return NotificationMethod(view.characters8(), view.length());
+  return NotificationMethod(view.characters16(), view.length());
+}
+
+// Whether the view holds the ASCII string needle, searched in place.
+template <typename Char>
+bool ViewContains(const Char* chars, size_t length, const std::string& needle) {
+  return std::search(chars, chars + length, needle.begin(), needle.end(),
+                     [](Char c, char n) { return c == static_cast<Char>(n); })
+         != chars + length;
+}
+
+bool ViewContains(const StringView& view, const std::string& needle) {
+  if (view.is8Bit())
+    return ViewContains(view.characters8(), view.length(), needle);
+  return ViewContains(view.characters16(), view.length(), needle);
+}
+
+// Neither kind of view ends in a NUL. Incoming 8-bit views only hold
+// ASCII (see Utf8ToStringView()) and are printed as they are; only 16-bit
+// ones are transcoded.
+void LogIncomingMessage(const char* what, const StringView& view) {
+  if (view.is8Bit()) {
+    fprintf(gLogStream, "v8inspector: %s message: %.*s\n", what,
+            static_cast<int>(view.length()),
+            reinterpret_cast<const char*>(view.characters8()));
+  } else {
+    fprintf(gLogStream, "v8inspector: %s message: %s\n", what,
+            StringViewToUtf8(view).c_str());
+  }
+}
+
+// Returns the method of a request from the frontend, or an empty string.
+// Unlike V8, frontends tend to put "id" first; the first "method" key is
+// taken, which is good enough to pick a lane.
+std::string RequestMethod(const std::string& message) {
+  static const char kKey[] = "\"method\"";
+  static const char kSpace[] = " \t\r\n";
+  size_t start = message.find(kKey);
+  if (start == std::string::npos)
+    return std::string();
+  start = message.find_first_not_of(kSpace, start + sizeof(kKey) - 1);
+  if (start == std::string::npos || message[start] != ':')
+    return std::string();
+  start = message.find_first_not_of(kSpace, start + 1);
+  if (start == std::string::npos || message[start] != '"')
+    return std::string();
+  size_t end = message.find('"', ++start);
+  if (end == std::string::npos)
+    return std::string();
+  return message.substr(start, end - start);
+}
+
 void HandleSyncCloseCb(uv_handle_t* handle) {
   *static_cast<bool*>(handle->data) = true;
 }
@@ -139,14 +212,39 @@ void ReleasePairOnAsyncClose(uv_handle_t* async) {
   delete pair;
 }
 
+// Keeps the characters it hands out a view of, which StringBuffer::create()
+// would have copied.
+class OwnedStringBuffer : public StringBuffer {
+ public:
+  // Latin-1, and so ASCII, text is viewed 8 bits at a time.
+  explicit OwnedStringBuffer(std::string latin1)
+      : latin1_(std::move(latin1)),
+        view_(reinterpret_cast<const uint8_t*>(latin1_.data()),
+              latin1_.length()) {}
+  explicit OwnedStringBuffer(std::vector<uint16_t> utf16)
+      : utf16_(std::move(utf16)),
+        view_(utf16_.data(), utf16_.size()) {}
+
+  const StringView& string() override { return view_; }
+
+ private:
+  std::string latin1_;
+  std::vector<uint16_t> utf16_;
+  StringView view_;
+};
+
 }  // namespace
 
-std::unique_ptr<StringBuffer> Utf8ToStringView(const std::string& message) {
-  UnicodeString utf16 =
-      UnicodeString::fromUTF8(StringPiece(message.data(), message.length()));
-  StringView view(reinterpret_cast<const uint16_t*>(utf16.getBuffer()),
-                  utf16.length());
-  return StringBuffer::create(view);
+std::unique_ptr<StringBuffer> Utf8ToStringView(std::string message,
+                                               bool ascii) {
+  if (ascii) {
+    // ASCII is valid Latin-1, V8 takes it as 8-bit characters as is.
+    return std::unique_ptr<StringBuffer>(
+        new OwnedStringBuffer(std::move(message)));
+  }
+  std::vector<uint16_t> utf16(message.length());
+  utf16.resize(Utf8ToUtf16(message.data(), message.length(), utf16.data()));
+  return std::unique_ptr<StringBuffer>(new OwnedStringBuffer(std::move(utf16)));
 }
 
 
@@ -171,17 +269,25 @@ class InspectorIoDelegate: public inspector::SocketServerDelegate {
   //   kStartSession
   bool StartSession(int session_id, const std::string& target_id) override;
   //   kSendMessage
-  void MessageReceived(int session_id, const std::string& message) override;
+  void MessageReceived(int session_id, std::string message,
+                       bool ascii) override;
   //   kEndSession
   void EndSession(int session_id) override;
 
   std::vector<std::string> GetTargetIds() override;
   std::string GetTargetTitle(const std::string& id) override;
   std::string GetTargetUrl(const std::string& id) override;
+  // Targets posted with InspectorIo::AddTarget() and RemoveTarget().
+  void AddTarget(const std::string& id, const std::string& title,
+                 const std::string& url);
+  void RemoveTarget(const std::string& id);
   bool IsConnected() { return connected_; }
   void ServerDone() override {
     io_->ServerDone();
   }
+  void WritePressureChanged(int session_id, bool congested) override {
+    io_->WritePressureChanged(congested);
+  }
 
  private:
   InspectorIo* io_;
@@ -189,7 +295,10 @@ class InspectorIoDelegate: public inspector::SocketServerDelegate {
   int session_id_;
   const std::string script_name_;
   const std::string script_path_;
-  const std::string target_id_;
+  // The target given at construction, and those added since, in order.
+  std::vector<std::string> target_ids_;
+  // Title and URL of the added targets.
+  std::map<std::string, std::pair<std::string, std::string>> added_targets_;
   bool waiting_;
 };
 
@@ -222,35 +331,64 @@ InspectorIo::InspectorIo(Isolate* isolate, Platform* platform,
                          const std::string& path, std::string host_name,
                          bool wait_for_connect, std::string file_path,
                          Agent *agent,
-                         const std::string &target_id)
-                         : thread_(), delegate_(nullptr),
+                         const std::string &target_id,
+                         const InspectorOptions& options)
+                         : thread_(), launched_(false),
+                           frontend_url_(frontend_url_promise_.get_future()),
+                           delegate_(nullptr),
                            state_(State::kNew), isolate_(isolate),
                            thread_req_(), platform_(platform),
+                           dispatch_pending_(false),
+                           main_thread_state_(MainThreadState::kIdle),
+                           wakeup_time_ns_(0),
+                           congested_sessions_(0),
                            dispatching_messages_(false), session_id_(0),
                            script_name_(path),
                            wait_for_connect_(wait_for_connect), host_name_(host_name), port_(0),
-                           file_path_(file_path), agent_(agent), target_id_(target_id)
+                           file_path_(file_path), agent_(agent), target_id_(target_id),
+                           target_ids_(1, target_id), options_(options)
 {
   main_thread_req_ = new AsyncAndAgent({uv_async_t(), agent_});
-  assert(0 == uv_async_init(uv_default_loop(), &main_thread_req_->first,
-                            InspectorIo::MainThreadReqAsyncCb));
+  int err = uv_async_init(uv_default_loop(), &main_thread_req_->first,
+                          InspectorIo::MainThreadReqAsyncCb);
+  assert(err == 0);
   uv_unref(reinterpret_cast<uv_handle_t*>(&main_thread_req_->first));
-  assert(0 == uv_sem_init(&thread_start_sem_, 0));
-  //uv_cond_init(&incoming_message_cond_);
-  //uv_mutex_init(&state_lock_);
-
-  IOStartUp<InspectorSocketServer>();
+  err = uv_sem_init(&thread_start_sem_, 0);
+  assert(err == 0);
+  (void) err;
+  main_thread_ios[isolate_] = this;
+  isolate_->AddBeforeCallEnteredCallback(BeforeCallEntered);
+  isolate_->AddCallCompletedCallback(CallCompleted);
 }
 
 InspectorIo::~InspectorIo() {
+  isolate_->RemoveBeforeCallEnteredCallback(BeforeCallEntered);
+  isolate_->RemoveCallCompletedCallback(CallCompleted);
+  auto registered = main_thread_ios.find(isolate_);
+  if (registered != main_thread_ios.end() && registered->second == this)
+    main_thread_ios.erase(registered);
   uv_sem_destroy(&thread_start_sem_);
   uv_close(reinterpret_cast<uv_handle_t*>(&main_thread_req_->first),
            ReleasePairOnAsyncClose);
 }
 
+bool InspectorIo::Launch() {
+  if (launched_)
+    return true;
+  if (state_ == State::kError)
+    return false;
+  int err = uv_thread_create(&thread_, InspectorIo::ThreadMain, this);
+  launched_ = err == 0;
+  if (!launched_) {
+    state_ = State::kError;
+    frontend_url_promise_.set_value(std::string());
+  }
+  return launched_;
+}
+
 bool InspectorIo::Start() {
-  assert(state_ == State::kNew);
-  assert(uv_thread_create(&thread_, InspectorIo::ThreadMain, this) == 0);
+  if (!Launch())
+    return false;
   uv_sem_wait(&thread_start_sem_);
 
   if (state_ == State::kError) {
@@ -273,7 +411,13 @@ void InspectorIo::Stop() {
 }
 
 bool InspectorIo::IsConnected() {
-  return delegate_ != nullptr && delegate_->IsConnected();
+  // delegate_ is set by the IO thread during startup.
+  return StartupDone() && delegate_ != nullptr && delegate_->IsConnected();
+}
+
+bool InspectorIo::StartupDone() const {
+  return frontend_url_.wait_for(std::chrono::seconds(0)) ==
+         std::future_status::ready;
 }
 
 bool InspectorIo::IsStarted() {
@@ -294,7 +438,18 @@ void InspectorIo::WaitForDisconnect() {
 
 // static
 void InspectorIo::ThreadMain(void* io) {
-  static_cast<InspectorIo*>(io)->ThreadMain<InspectorSocketServer>();
+  InspectorIo* inspector_io = static_cast<InspectorIo*>(io);
+  switch (inspector_io->options_.transport) {
+  case TransportType::kSocket:
+    inspector_io->ThreadMain<InspectorSocketServer>();
+    break;
+  case TransportType::kLoopback:
+    inspector_io->ThreadMain<LoopbackTransport>();
+    break;
+  case TransportType::kSharedMemory:
+    inspector_io->ThreadMain<ShmRingTransport>();
+    break;
+  }
 }
 
 // static
@@ -307,9 +462,19 @@ void InspectorIo::IoThreadAsyncCb(uv_async_t* async) {
   }
   Transport* transport = transport_and_io->first;
   InspectorIo* io = transport_and_io->second;
-  MessageQueue<TransportAction> outgoing_message_queue;
-  io->SwapBehindLock(&io->outgoing_message_queue_, &outgoing_message_queue);
-  for (const auto& outgoing : outgoing_message_queue) {
+  TargetUpdate update;
+  while (io->target_update_queue_.Pop(&update)) {
+    if (update.add) {
+      io->delegate_->AddTarget(update.id, update.title, update.url);
+      transport->AddTarget(update.id, update.title, update.url);
+    } else {
+      io->delegate_->RemoveTarget(update.id);
+      transport->RemoveTarget(update.id);
+    }
+  }
+  MessageQueue<TransportAction, std::string>::value_type outgoing;
+  transport->Cork();
+  while (io->outgoing_message_queue_.Pop(&outgoing)) {
     switch (std::get<0>(outgoing)) {
     case TransportAction::kKill:
       transport->TerminateConnections();
@@ -318,12 +483,12 @@ void InspectorIo::IoThreadAsyncCb(uv_async_t* async) {
       transport->Stop(nullptr);
       break;
     case TransportAction::kSendMessage:
-      std::string message = StringViewToUtf8(std::get<2>(outgoing)->string());
-      //fprintf(gLogStream, "v8inspector: %d %s sending message %s \n", __LINE__, __FILE__, message.c_str());
-      transport->Send(std::get<1>(outgoing), message);
+      //fprintf(gLogStream, "v8inspector: %d %s sending message %s \n", __LINE__, __FILE__, std::get<2>(outgoing).c_str());
+      transport->Send(std::get<1>(outgoing), std::move(std::get<2>(outgoing)));
       break;
     }
   }
+  transport->Uncork();
 }
   template <typename Transport> struct server_data_type
   {
@@ -345,8 +510,10 @@ void InspectorIo::IoThreadAsyncCb(uv_async_t* async) {
         }
   };
 
+// Runs on the IO thread before its loop. The main thread waits on
+// thread_start_sem_ or frontend_url_ before it reads what is set here.
 template<typename Transport>
-void InspectorIo::IOStartUp() {
+bool InspectorIo::IOStartUp() {
 
     server_data_type<Transport> *server_data = new server_data_type<Transport>;
     server_data_ = server_data;
@@ -367,36 +534,68 @@ void InspectorIo::IOStartUp() {
       if(! server_data->jsFile) 
       {
          fprintf(gLogStream, "v8inspector: Unable to open file %s\n", file_path_.c_str());
-         return;
+         state_ = State::kError;
+         CloseAsyncAndLoop(&thread_req_);
+         frontend_url_promise_.set_value(std::string());
+         uv_sem_post(&thread_start_sem_);
+         return false;
       }
   }
 
-  server_data->server = new Transport(delegate_, &server_data->loop, host_name_, port_, server_data->jsFile);
+  server_data->server = new Transport(delegate_, &server_data->loop, host_name_, port_, options_, &stats_, server_data->jsFile);
 
   server_data->queue_transport = new TransportAndIo<Transport>(server_data->server, this);
   thread_req_.data = server_data->queue_transport;
   std::string debugURL;
   if (! server_data->server->Start(debugURL)) {
-    state_ = State::kError;  // Safe, main thread is waiting on semaphore
-    assert(0 == CloseAsyncAndLoop(&thread_req_));
+    state_ = State::kError;
+    int err = CloseAsyncAndLoop(&thread_req_);
+    assert(err == 0);
+    (void) err;
+    frontend_url_promise_.set_value(std::string());
     uv_sem_post(&thread_start_sem_);
-    return;
+    return false;
   }
   
-  port_ = server_data->server->Port();  // Safe, main thread is waiting on semaphore.
+  port_ = server_data->server->Port();
+  if (options_.transport != TransportType::kSocket)
+    frontend_url_promise_.set_value(debugURL);
+  else if (!options_.unix_socket_path.empty())
+    frontend_url_promise_.set_value(
+        FormatWsUnixAddress(options_.unix_socket_path, target_id_, true));
+  else
+    frontend_url_promise_.set_value(
+        MakeFrontEndURL(host_name_, port_, target_id_));
+  // Targets added while starting up did not wake the thread.
+  err = uv_async_send(&thread_req_);
+  assert(err == 0);
   if (!wait_for_connect_) {
     uv_sem_post(&thread_start_sem_);
   }
+  return true;
 }
+LoopbackTransport* InspectorIo::loopback_transport() {
+  if (options_.transport != TransportType::kLoopback)
+    return nullptr;
+  frontend_url_.wait();
+  if (state_ == State::kError)
+    return nullptr;
+  return static_cast<server_data_type<LoopbackTransport>*>(server_data_)
+      ->server;
+}
+
 template<typename Transport>
 void InspectorIo::ThreadMain() {
-//  IOStartUp<Transport>();
+  if (!IOStartUp<Transport>())
+    return;
 
   server_data_type<Transport> *server_data = reinterpret_cast<server_data_type<Transport> *> (server_data_);
   
   uv_run(&server_data->loop, UV_RUN_DEFAULT);
   thread_req_.data = nullptr;
-  assert(uv_loop_close(&server_data->loop) ==  0);
+  int err = uv_loop_close(&server_data->loop);
+  assert(err == 0);
+  (void) err;
   delegate_ = nullptr;
   if(server_data->jsFile)
      fclose(server_data->jsFile);
@@ -407,31 +606,15 @@ void InspectorIo::ThreadMain() {
   delete server_data;
 }
 
-template <typename ActionType>
-bool InspectorIo::AppendMessage(MessageQueue<ActionType>* queue,
+template <typename ActionType, typename MessageType>
+void InspectorIo::AppendMessage(MessageQueue<ActionType, MessageType>* queue,
                                 ActionType action, int session_id,
-                                std::unique_ptr<StringBuffer> buffer) {
-  state_lock_.lock();
-  //uv_mutex_lock(&state_lock_);
-  bool trigger_pumping = queue->empty();
-  queue->push_back(std::make_tuple(action, session_id, std::move(buffer)));
-  state_lock_.unlock();
-  //uv_mutex_unlock(&state_lock_);
-  return trigger_pumping;
-}
-
-template <typename ActionType>
-void InspectorIo::SwapBehindLock(MessageQueue<ActionType>* vector1,
-                                 MessageQueue<ActionType>* vector2) {
-  state_lock_.lock();
-  //uv_mutex_lock(&state_lock_);
-  vector1->swap(*vector2);
-  state_lock_.unlock();
-  //uv_mutex_unlock(&state_lock_);
+                                MessageType message) {
+  queue->Push(std::make_tuple(action, session_id, std::move(message)));
 }
 
 void InspectorIo::PostIncomingMessage(InspectorAction action, int session_id,
-                                      const std::string& message) {
+                                      std::string message, bool ascii) {
     if(! agent_->IsValid())
     {
         fprintf(gLogStream, "v8inspector: #### Invalid agent found in %s %d\n", __FILE__, __LINE__);
@@ -439,33 +622,174 @@ void InspectorIo::PostIncomingMessage(InspectorAction action, int session_id,
     }
 
     //fprintf(gLogStream, "v8inspector: %s %d appending action %d session %d and  message %s\n", __FILE__, __LINE__, action, session_id, message.c_str());
-  if (AppendMessage(&incoming_message_queue_, action, session_id,
-                    Utf8ToStringView(message))) {
-    Agent* agent = main_thread_req_->second;
-    platform_->CallOnForegroundThread(isolate_,
-                                      new DispatchMessagesTask(agent));
+  IncomingQueue* queue = &incoming_message_queue_;
+  const std::vector<std::string>& priority = options_.priority_methods;
+  if (action == InspectorAction::kSendMessage && !priority.empty() &&
+      std::find(priority.begin(), priority.end(), RequestMethod(message)) !=
+          priority.end()) {
+    queue = &priority_message_queue_;
+  }
+  AppendMessage(queue, action, session_id,
+                IncomingMessage{Utf8ToStringView(std::move(message), ascii),
+                                uv_hrtime()});
+  // A burst of messages costs the main thread a single wakeup. The state is
+  // read after the flag is set, and the main thread sets its state before it
+  // looks at the flag, so a change of state cannot hide the wakeup.
+  if (!dispatch_pending_.exchange(true)) {
+    wakeup_time_ns_ = uv_hrtime();
+    WakeMainThread(main_thread_state_);
+  }
+}
+
+void InspectorIo::WakeMainThread(MainThreadState state) {
+  Agent* agent = main_thread_req_->second;
+  switch (state) {
+  case MainThreadState::kRunning:
+    StatsAdd(&stats_.wakeups_interrupt, 1);
     isolate_->RequestInterrupt(InterruptCallback, agent);
-    assert(0 == uv_async_send(&main_thread_req_->first));
+    break;
+  case MainThreadState::kIdle:
+    if (options_.wake_uv_loop) {
+      StatsAdd(&stats_.wakeups_uv_async, 1);
+      int err = uv_async_send(&main_thread_req_->first);
+      assert(err == 0);
+      (void) err;
+    } else {
+      StatsAdd(&stats_.wakeups_task, 1);
+      platform_->CallOnForegroundThread(isolate_,
+                                        new DispatchMessagesTask(agent));
+    }
+    break;
+  case MainThreadState::kPaused:
+  {
+    StatsAdd(&stats_.wakeups_paused, 1);
+    std::unique_lock<std::mutex> lck(park_lock_);
+    incoming_message_cond_.notify_all();
+    break;
+  }
   }
-  NotifyMessageReceived();
+}
+
+void InspectorIo::SetMainThreadState(MainThreadState state) {
+  main_thread_state_ = state;
+  // While dispatching, the queue is drained before the flag is cleared.
+  if (dispatch_pending_ && !dispatching_messages_)
+    WakeMainThread(state);
+}
+
+// static
+void InspectorIo::BeforeCallEntered(Isolate* isolate) {
+  auto registered = main_thread_ios.find(isolate);
+  if (registered == main_thread_ios.end())
+    return;
+  InspectorIo* io = registered->second;
+  // Called for every call into JavaScript, nested ones included.
+  if (io->main_thread_state_.load(std::memory_order_relaxed) ==
+      MainThreadState::kIdle) {
+    io->SetMainThreadState(MainThreadState::kRunning);
+  }
+}
+
+// static
+void InspectorIo::CallCompleted(Isolate* isolate) {
+  auto registered = main_thread_ios.find(isolate);
+  if (registered == main_thread_ios.end())
+    return;
+  InspectorIo* io = registered->second;
+  // Only called once the outermost call returns.
+  if (io->main_thread_state_.load(std::memory_order_relaxed) ==
+      MainThreadState::kRunning) {
+    io->SetMainThreadState(MainThreadState::kIdle);
+  }
+}
+
+void InspectorIo::WritePressureChanged(bool congested) {
+  std::unique_lock<std::mutex> lck(park_lock_);
+  congested_sessions_ += congested ? 1 : -1;
+  if (congested_sessions_ == 0)
+    write_queue_cond_.notify_all();
+}
+
+bool InspectorIo::WaitForWriteQueue(const StringView& message) {
+  if (congested_sessions_ == 0)
+    return true;
+  switch (options_.backpressure_policy) {
+  case BackpressurePolicy::kBlock:
+  {
+    uint64_t start = uv_hrtime();
+    std::unique_lock<std::mutex> lck(park_lock_);
+    write_queue_cond_.wait(lck, [this] { return congested_sessions_ == 0; });
+    StatsAdd(&stats_.backpressure_blocks, 1);
+    StatsAdd(&stats_.backpressure_blocked_ns, uv_hrtime() - start);
+    return true;
+  }
+  case BackpressurePolicy::kDropNotifications:
+  {
+    const std::vector<std::string>& droppable = options_.droppable_methods;
+    std::string method = NotificationMethod(message);
+    if (!method.empty() &&
+        std::find(droppable.begin(), droppable.end(), method) !=
+            droppable.end()) {
+      StatsAdd(&stats_.backpressure_dropped, 1);
+      return false;
+    }
+    return true;
+  }
+  case BackpressurePolicy::kDisconnect:
+    // The server closes the session, nothing to hold back here.
+    return true;
+  }
+  return true;
 }
 
 std::vector<std::string> InspectorIo::GetTargetIds() const {
-  return delegate_ ? delegate_->GetTargetIds() : std::vector<std::string>();
+  return target_ids_;
 }
 
-void InspectorIo::WaitForFrontendMessageWhilePaused() {
-  dispatching_messages_ = false;
-  std::unique_lock<std::mutex> lck(state_lock_);
-  if (incoming_message_queue_.empty())
-    incoming_message_cond_.wait(lck);
-    //uv_cond_wait(&incoming_message_cond_, &state_lock_);
+void InspectorIo::AddTarget(const std::string& id, const std::string& title,
+                            const std::string& url) {
+  if (std::find(target_ids_.begin(), target_ids_.end(), id) ==
+      target_ids_.end()) {
+    target_ids_.push_back(id);
+  }
+  PostTargetUpdate({true, id, title, url});
 }
 
-void InspectorIo::NotifyMessageReceived() {
-  std::unique_lock<std::mutex> lck(state_lock_);
-  incoming_message_cond_.notify_all();
-  //uv_cond_broadcast(&incoming_message_cond_);
+void InspectorIo::RemoveTarget(const std::string& id) {
+  auto it = std::find(target_ids_.begin(), target_ids_.end(), id);
+  if (it == target_ids_.end())
+    return;
+  target_ids_.erase(it);
+  PostTargetUpdate({false, id, std::string(), std::string()});
+}
+
+void InspectorIo::PostTargetUpdate(TargetUpdate update) {
+  target_update_queue_.Push(std::move(update));
+  // thread_req_ is initialized before the frontend URL is set, and closed
+  // by the time the IO thread is joined.
+  if (!StartupDone() || state_ == State::kError ||
+      state_ == State::kShutDown) {
+    return;
+  }
+  int err = uv_async_send(&thread_req_);
+  assert(err == 0);
+  (void) err;
+}
+
+void InspectorIo::WaitForFrontendMessageWhilePaused() {
+  dispatching_messages_ = false;
+  {
+    // Holding the lock from before the state is set keeps a notification
+    // from slipping in ahead of the wait. A wakeup already pending, maybe
+    // an interrupt that cannot run while paused, ends the wait at once.
+    std::unique_lock<std::mutex> lck(park_lock_);
+    MainThreadState state =
+        main_thread_state_.exchange(MainThreadState::kPaused);
+    incoming_message_cond_.wait(
+        lck, [this] { return dispatch_pending_.load(); });
+    main_thread_state_ = state;
+  }
+  DispatchMessages();
 }
 
 void InspectorIo::DispatchMessages() {
@@ -476,16 +800,17 @@ void InspectorIo::DispatchMessages() {
   if (dispatching_messages_)
     return;
   dispatching_messages_ = true;
-  bool had_messages = false;
-  do {
-    if (dispatching_message_queue_.empty())
-      SwapBehindLock(&incoming_message_queue_, &dispatching_message_queue_);
-    had_messages = !dispatching_message_queue_.empty();
-    while (!dispatching_message_queue_.empty()) {
-      MessageQueue<InspectorAction>::value_type task;
-      std::swap(dispatching_message_queue_.front(), task);
-      dispatching_message_queue_.pop_front();
-      StringView message = std::get<2>(task)->string();
+  uint64_t woken = wakeup_time_ns_.exchange(0);
+  if (woken != 0) {
+    StatsAdd(&stats_.wakeup_dispatches, 1);
+    StatsAdd(&stats_.wakeup_latency_ns, uv_hrtime() - woken);
+  }
+  // Pop() moves on to messages posted meanwhile, so this drains the queue.
+  // dispatch_pending_ stays set until then, to spare the posts a wakeup.
+  IncomingQueue::value_type task;
+  for (;;) {
+    while (NextIncomingMessage(&task)) {
+      StringView message = std::get<2>(task).buffer->string();
       switch (std::get<0>(task)) {
       case InspectorAction::kStartSession:
         assert(session_delegate_ == nullptr);
@@ -509,25 +834,59 @@ void InspectorIo::DispatchMessages() {
         break;
       case InspectorAction::kSendMessage:
       {
-          std::wstring s = (const wchar_t *)message.characters16();
           // BUGBUG ToFix
           // This message is generated by chrome devtools when opening a global object in the debugger pane
           // Using v8 7.1.302.4 this call will crash v8inspector in v8.dll
-          if(s.find(L"\"ownProperties\":true") != std::string::npos)
+          if(ViewContains(message, "\"ownProperties\":true"))
           {
-              fprintf(gLogStream, "v8inspector: SKIPPING message: %S\n", s.c_str());
+              LogIncomingMessage("SKIPPING", message);
               continue;
           }
-          fprintf(gLogStream, "v8inspector: Dispatching message: %S\n", s.c_str());
+          LogIncomingMessage("Dispatching", message);
           agent_->Dispatch(message);
           break;
       }
       }
     }
-  } while (had_messages);
+    // Posts that found the flag set woke nobody, look again for any that
+    // came in before it was cleared.
+    dispatch_pending_ = false;
+    if (!incoming_message_queue_.Pending() &&
+        !priority_message_queue_.Pending()) {
+      break;
+    }
+    dispatch_pending_ = true;
+  }
   dispatching_messages_ = false;
 }
 
+// A priority message may only overtake others of its own session: one for a
+// session that is still to start waits for the kStartSession in the normal
+// lane, and one left once the normal lane is empty is for a session that
+// has ended.
+bool InspectorIo::NextIncomingMessage(IncomingQueue::value_type* task) {
+  for (;;) {
+    IncomingQueue::value_type* urgent = priority_message_queue_.Front();
+    if (urgent != nullptr && session_delegate_ != nullptr &&
+        std::get<1>(*urgent) == session_id_) {
+      priority_message_queue_.Pop(task);
+      StatsAdd(&stats_.priority_messages, 1);
+      StatsAdd(&stats_.priority_queue_delay_ns,
+               uv_hrtime() - std::get<2>(*task).queued_ns);
+      return true;
+    }
+    if (incoming_message_queue_.Pop(task)) {
+      StatsAdd(&stats_.normal_messages, 1);
+      StatsAdd(&stats_.normal_queue_delay_ns,
+               uv_hrtime() - std::get<2>(*task).queued_ns);
+      return true;
+    }
+    if (urgent == nullptr)
+      return false;
+    priority_message_queue_.Pop(task);
+  }
+}
+
 // static
 void InspectorIo::MainThreadReqAsyncCb(uv_async_t* req) {
   AsyncAndAgent* pair = ContainerOf(&AsyncAndAgent::first, req);
@@ -542,10 +901,17 @@ void InspectorIo::Write(TransportAction action, int session_id,
                         const StringView& inspector_message) {
   if (state_ == State::kShutDown)
     return;
+  if (action == TransportAction::kSendMessage &&
+      !WaitForWriteQueue(inspector_message)) {
+    return;
+  }
+  // Converted here rather than on the IO thread, so the message is copied
+  // once, straight into what becomes the frame payload.
   AppendMessage(&outgoing_message_queue_, action, session_id,
-                StringBuffer::create(inspector_message));
+                StringViewToUtf8(inspector_message));
   int err = uv_async_send(&thread_req_);
   assert(0 == err);
+  (void) err;
 }
 
 InspectorIoDelegate::InspectorIoDelegate(InspectorIo* io,
@@ -558,7 +924,7 @@ InspectorIoDelegate::InspectorIoDelegate(InspectorIo* io,
                                            session_id_(0),
                                            script_name_(script_name),
                                            script_path_(script_path),
-                                           target_id_(target_id),
+                                           target_ids_(1, target_id),
                                            waiting_(wait) 
 {
 }
@@ -575,7 +941,8 @@ bool InspectorIoDelegate::StartSession(int session_id,
 }
 
 void InspectorIoDelegate::MessageReceived(int session_id,
-                                          const std::string& message) {
+                                          std::string message,
+                                          bool ascii) {
   if (waiting_) {
     if (message.find("\"Runtime.runIfWaitingForDebugger\"") !=
         std::string::npos) {
@@ -584,7 +951,7 @@ void InspectorIoDelegate::MessageReceived(int session_id,
     }
   }
   io_->PostIncomingMessage(InspectorAction::kSendMessage, session_id,
-                           message);
+                           std::move(message), ascii);
 }
 
 void InspectorIoDelegate::EndSession(int session_id) {
@@ -593,17 +960,39 @@ void InspectorIoDelegate::EndSession(int session_id) {
 }
 
 std::vector<std::string> InspectorIoDelegate::GetTargetIds() {
-  return { target_id_ };
+  return target_ids_;
 }
 
 std::string InspectorIoDelegate::GetTargetTitle(const std::string& id) {
+  auto added = added_targets_.find(id);
+  if (added != added_targets_.end())
+    return added->second.first;
   return script_name_.empty() ? GetProcessTitle() : script_name_;
 }
 
 std::string InspectorIoDelegate::GetTargetUrl(const std::string& id) {
+  auto added = added_targets_.find(id);
+  if (added != added_targets_.end())
+    return added->second.second;
   return "file://" + script_path_;
 }
 
+void InspectorIoDelegate::AddTarget(const std::string& id,
+                                    const std::string& title,
+                                    const std::string& url) {
+  if (std::find(target_ids_.begin(), target_ids_.end(), id) ==
+      target_ids_.end()) {
+    target_ids_.push_back(id);
+  }
+  added_targets_[id] = std::make_pair(title, url);
+}
+
+void InspectorIoDelegate::RemoveTarget(const std::string& id) {
+  target_ids_.erase(std::remove(target_ids_.begin(), target_ids_.end(), id),
+                    target_ids_.end());
+  added_targets_.erase(id);
+}
+
 bool IoSessionDelegate::WaitForFrontendMessageWhilePaused() {
   io_->WaitForFrontendMessageWhilePaused();
   return true;
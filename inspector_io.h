@@ -25,13 +25,17 @@
 
 #include "inspector_socket_server.h"
 #include "inspector_agent.h"
+#include "inspector_options.h"
+#include "inspector_queue.h"
+#include "inspector_stats.h"
 #include "uv.h"
 #include <v8.h>
 
-#include <deque>
+#include <atomic>
 #include <memory>
 #include <stddef.h>
 #include <condition_variable>
+#include <future>
 #include <mutex>
 
 namespace v8_inspector {
@@ -45,8 +49,15 @@ using namespace v8;
 std::string FormatWsAddress(const std::string& host, int port,
                             const std::string& target_id,
                             bool include_protocol);
+std::string FormatWsUnixAddress(const std::string& socket_path,
+                                const std::string& target_id,
+                                bool include_protocol);
+std::string MakeFrontEndURL(const std::string& host,
+                            int port,
+                            const std::string& id);
 
 class InspectorIoDelegate;
+class LoopbackTransport;
 
 enum class InspectorAction {
   kStartSession,
@@ -64,11 +75,15 @@ enum class TransportAction {
 class InspectorIo {
  public:
   InspectorIo(Isolate* isolate, Platform* platform,
-              const std::string& path, std::string host_name, bool wait_for_connect, std::string file_path_, Agent *agent, const std::string &target_id);
+              const std::string& path, std::string host_name, bool wait_for_connect, std::string file_path_, Agent *agent, const std::string &target_id,
+              const InspectorOptions& options);
 
   ~InspectorIo();
-  // Start the inspector agent thread, waiting for it to initialize,
-  // and waiting as well for a connection if wait_for_connect.
+  // Start the inspector agent thread, which resolves the host, listens and
+  // writes the URL file. Returns without waiting for it.
+  bool Launch();
+  // Launch() if that was not done yet, then wait for the thread to
+  // initialize, and as well for a connection if wait_for_connect.
   bool Start();
   // Stop the inspector agent thread.
   void Stop();
@@ -78,19 +93,40 @@ class InspectorIo {
 
   void WaitForDisconnect();
   // Called from thread to queue an incoming message and trigger
-  // DispatchMessages() on the main thread.
+  // DispatchMessages() on the main thread. ascii skips transcoding for
+  // messages known to be 7-bit ASCII.
   void PostIncomingMessage(InspectorAction action, int session_id,
-                           const std::string& message);
+                           std::string message, bool ascii = false);
   void ResumeStartup() {
     uv_sem_post(&thread_start_sem_);
   }
   void ServerDone() {
     uv_close(reinterpret_cast<uv_handle_t*>(&thread_req_), nullptr);
   }
+  // Called from thread when a session's write queue crosses a watermark.
+  void WritePressureChanged(bool congested);
 
+  // Only valid once frontend_url() is ready.
   int port() const { return port_; }
+  // Set by the IO thread when the transport is up: the URL to open the
+  // target with, or empty if it failed to start.
+  std::shared_future<std::string> frontend_url() const {
+    return frontend_url_;
+  }
+  // The transport if InspectorOptions::transport is kLoopback. Waits for
+  // the IO thread to create it.
+  LoopbackTransport* loopback_transport();
   std::string host() const { return host_name_; }
+  // Main thread. Announce or withdraw a debuggable target besides the one
+  // the agent was created with. The IO thread applies them in order, to
+  // the delegate and to the transport's registry, so the transport never
+  // re-reads the whole list.
+  void AddTarget(const std::string& id, const std::string& title,
+                 const std::string& url);
+  void RemoveTarget(const std::string& id);
+  // Main thread. The targets announced so far.
   std::vector<std::string> GetTargetIds() const;
+  const InspectorStats& stats() const { return stats_; }
 
   enum class State {
     kNew,
@@ -102,17 +138,30 @@ class InspectorIo {
   };
 
  private:
-  template <typename Action>
-  using MessageQueue =
-      std::deque<std::tuple<Action, int,
-                  std::unique_ptr<v8_inspector::StringBuffer>>>;
+  // Incoming messages are queued as V8 takes them, outgoing ones already
+  // converted to UTF-8 for the transport.
+  template <typename Action, typename Message>
+  using MessageQueue = AtomicQueue<std::tuple<Action, int, Message>>;
+  // An incoming message, and when the IO thread queued it.
+  struct IncomingMessage {
+    std::unique_ptr<v8_inspector::StringBuffer> buffer;
+    uint64_t queued_ns;
+  };
+  using IncomingQueue = MessageQueue<InspectorAction, IncomingMessage>;
+  struct TargetUpdate {
+    bool add;  // Removed otherwise
+    std::string id;
+    std::string title;
+    std::string url;
+  };
   // Callback for main_thread_req_'s uv_async_t
   static void MainThreadReqAsyncCb(uv_async_t* req);
 
   // Wrapper for agent->ThreadMain()
   static void ThreadMain(void* agent);
 
-  template<typename Transport> void IOStartUp();
+  template<typename Transport> bool IOStartUp();
+  bool StartupDone() const;
   template <typename Transport> void ThreadMain();
   // Called by ThreadMain's loop when triggered by thread_req_, writes
   // messages from outgoing_message_queue to the InspectorSockerServer
@@ -123,24 +172,44 @@ class InspectorIo {
   // Write action to outgoing_message_queue, and wake the thread
   void Write(TransportAction action, int session_id,
              const v8_inspector::StringView& message);
-  // Thread-safe append of message to a queue. Return true if the queue
-  // used to be empty.
-  template <typename ActionType>
-  bool AppendMessage(MessageQueue<ActionType>* vector, ActionType action,
-                     int session_id,
-                     std::unique_ptr<v8_inspector::StringBuffer> buffer);
-  // Used as equivalent of a thread-safe "pop" of an entire queue's content.
-  template <typename ActionType>
-  void SwapBehindLock(MessageQueue<ActionType>* vector1,
-                      MessageQueue<ActionType>* vector2);
-  // Wait on incoming_message_cond_
+  // Queue a target update, and wake the thread if it is up. Updates queued
+  // before that are sent on by IOStartUp().
+  void PostTargetUpdate(TargetUpdate update);
+  // Applies options_.backpressure_policy while a session is congested.
+  // Returns false if the message is to be dropped.
+  bool WaitForWriteQueue(const v8_inspector::StringView& message);
+  // Thread-safe append of message to a queue.
+  template <typename ActionType, typename MessageType>
+  void AppendMessage(MessageQueue<ActionType, MessageType>* queue,
+                     ActionType action, int session_id, MessageType message);
+  // Pops the next incoming message to dispatch, from the priority lane
+  // first. Returns false if there is none.
+  bool NextIncomingMessage(IncomingQueue::value_type* task);
+  // Park on incoming_message_cond_ until a message is posted, then
+  // dispatch it
   void WaitForFrontendMessageWhilePaused();
-  // Broadcast incoming_message_cond_
-  void NotifyMessageReceived();
+
+  // What the main thread is doing, as far as waking it goes.
+  enum class MainThreadState {
+    kIdle,     // Outside JavaScript, e.g. pumping the platform
+    kRunning,  // In JavaScript, only interrupts get through
+    kPaused    // Parked in WaitForFrontendMessageWhilePaused()
+  };
+  // Wake the main thread to dispatch, by the means that suits state
+  void WakeMainThread(MainThreadState state);
+  // Main thread. A wakeup chosen for the previous state may not get
+  // through in the new one, so one is sent again for the new state.
+  void SetMainThreadState(MainThreadState state);
+  // Isolate call hooks, tracking whether the main thread runs JavaScript
+  static void BeforeCallEntered(Isolate* isolate);
+  static void CallCompleted(Isolate* isolate);
 
   // The IO thread runs its own uv_loop to implement the TCP server off
   // the main thread.
   uv_thread_t thread_;
+  bool launched_;
+  std::promise<std::string> frontend_url_promise_;
+  std::shared_future<std::string> frontend_url_;
   // Used by Start() to wait for thread to initialize, or for it to initialize
   // and receive a connection if wait_for_connect was requested.
   uv_sem_t thread_start_sem_;
@@ -157,14 +226,28 @@ class InspectorIo {
   Platform* platform_;
   Isolate* isolate_;
 
-  // Message queues
+  // Message queues. Incoming ones are pushed by the IO thread and popped
+  // by the main thread; outgoing ones are pushed by the main thread and
+  // whichever V8 threads report to the session, and popped by the IO thread.
+  IncomingQueue incoming_message_queue_;
+  // Requests for options_.priority_methods, dispatched first.
+  IncomingQueue priority_message_queue_;
+  MessageQueue<TransportAction, std::string> outgoing_message_queue_;
+  AtomicQueue<TargetUpdate> target_update_queue_;
+  // Set by the first message posted after the main thread last drained
+  // incoming_message_queue_, which is the only post to wake it.
+  std::atomic<bool> dispatch_pending_;
+  std::atomic<MainThreadState> main_thread_state_;
+  // uv_hrtime() of the wakeup not yet dispatched, 0 if none.
+  std::atomic<uint64_t> wakeup_time_ns_;
+  // Only taken to park the main thread, while paused in the debugger or
+  // held back by a congested session.
+  std::mutex park_lock_;
   std::condition_variable incoming_message_cond_;
-  std::mutex state_lock_;
-  //uv_cond_t  incoming_message_cond_;
-  //uv_mutex_t state_lock_;  // Locked before mutating either queue.
-  MessageQueue<InspectorAction> incoming_message_queue_;
-  MessageQueue<TransportAction> outgoing_message_queue_;
-  MessageQueue<InspectorAction> dispatching_message_queue_;
+  // Sessions over the write queue high watermark, changed behind park_lock_
+  // and read without it on the fast path of Write().
+  std::atomic<int> congested_sessions_;
+  std::condition_variable write_queue_cond_;
 
   bool dispatching_messages_;
   int session_id_;
@@ -174,18 +257,25 @@ class InspectorIo {
   std::string host_name_;
   std::string file_path_;
   std::string target_id_;
+  // Main thread copy of the target list, target_id_ first.
+  std::vector<std::string> target_ids_;
   Agent *agent_;
   const bool wait_for_connect_;
   int port_;
 
+  const InspectorOptions options_;
+  InspectorStats stats_;
+
   void *server_data_ = nullptr;
   friend class DispatchMessagesTask;
   friend class IoSessionDelegate;
   friend void InterruptCallback(Isolate*, void* agent);
 };
 
+// The buffer takes message over, ASCII as 8-bit characters, anything else
+// transcoded to UTF-16.
 std::unique_ptr<v8_inspector::StringBuffer> Utf8ToStringView(
-    const std::string& message);
+    std::string message, bool ascii = false);
 
 }  // namespace inspector
 
@@ -0,0 +1,189 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+#include "inspector_loopback.h"
+#include "inspector_utf8.h"
+
+#include <cassert>
+#include <chrono>
+
+namespace inspector {
+
+LoopbackTransport::LoopbackTransport(SocketServerDelegate* delegate,
+                                     uv_loop_t* loop,
+                                     const std::string& host,
+                                     int port,
+                                     const InspectorOptions& options,
+                                     InspectorStats* stats,
+                                     FILE* out) : delegate_(delegate),
+                                                  loop_(loop),
+                                                  stats_(stats),
+                                                  next_session_id_(0),
+                                                  stopping_(false),
+                                                  stop_callback_(nullptr),
+                                                  closing_(false) {
+  // Set up here rather than in Start() so the embedder may post as soon as
+  // it can see the transport.
+  int err = uv_async_init(loop_, &events_async_, EventsCallback);
+  assert(err == 0);
+  (void) err;
+  events_async_.data = this;
+}
+
+LoopbackTransport::~LoopbackTransport() {
+  assert(sessions_.empty());
+}
+
+bool LoopbackTransport::Start(std::string &debugURL) {
+  debugURL.clear();
+  return true;
+}
+
+void LoopbackTransport::Stop(ServerCallback callback) {
+  stopping_ = true;
+  stop_callback_ = callback;
+  CloseIfDone();
+}
+
+void LoopbackTransport::Send(int session_id, std::string message) {
+  if (sessions_.count(session_id) == 0)
+    return;
+  std::lock_guard<std::mutex> lock(sent_lock_);
+  sent_.emplace_back(session_id, std::move(message));
+  sent_cond_.notify_all();
+}
+
+void LoopbackTransport::TerminateConnections() {
+  std::set<int> sessions = sessions_;
+  for (int session_id : sessions)
+    EndSession(session_id);
+}
+
+int LoopbackTransport::Connect(const std::string& target_id) {
+  int session_id = next_session_id_++;
+  Post(EventType::kConnect, session_id, target_id);
+  return session_id;
+}
+
+void LoopbackTransport::Inject(int session_id, std::string message) {
+  Post(EventType::kMessage, session_id, std::move(message));
+}
+
+void LoopbackTransport::Disconnect(int session_id) {
+  Post(EventType::kDisconnect, session_id, std::string());
+}
+
+bool LoopbackTransport::TakeSent(
+    size_t count, unsigned int timeout_ms,
+    std::vector<std::pair<int, std::string>>* messages) {
+  std::unique_lock<std::mutex> lock(sent_lock_);
+  bool done = sent_cond_.wait_for(lock,
+                                  std::chrono::milliseconds(timeout_ms),
+                                  [&] { return sent_.size() >= count; });
+  for (auto& message : sent_)
+    messages->push_back(std::move(message));
+  sent_.clear();
+  return done;
+}
+
+void LoopbackTransport::Post(EventType type, int session_id,
+                             std::string data) {
+  std::lock_guard<std::mutex> lock(events_lock_);
+  if (closing_)
+    return;
+  bool trigger = events_.empty();
+  events_.push_back(Event{type, session_id, std::move(data)});
+  if (trigger)
+    uv_async_send(&events_async_);
+}
+
+void LoopbackTransport::EndSession(int session_id) {
+  if (sessions_.erase(session_id) == 0)
+    return;
+  delegate_->EndSession(session_id);
+  CloseIfDone();
+}
+
+// Like the socket server, stopping waits for the sessions to end.
+void LoopbackTransport::CloseIfDone() {
+  if (!stopping_ || !sessions_.empty())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(events_lock_);
+    if (closing_)
+      return;
+    closing_ = true;
+  }
+  uv_close(reinterpret_cast<uv_handle_t*>(&events_async_), ClosedCallback);
+}
+
+// static
+void LoopbackTransport::EventsCallback(uv_async_t* async) {
+  LoopbackTransport* transport = static_cast<LoopbackTransport*>(async->data);
+  std::vector<Event> events;
+  {
+    std::lock_guard<std::mutex> lock(transport->events_lock_);
+    events.swap(transport->events_);
+  }
+  for (Event& event : events) {
+    switch (event.type) {
+    case EventType::kConnect:
+      if (!transport->stopping_ &&
+          transport->delegate_->StartSession(event.session_id, event.data)) {
+        transport->sessions_.insert(event.session_id);
+      }
+      break;
+    case EventType::kMessage: {
+      if (transport->sessions_.count(event.session_id) == 0)
+        break;
+      // Classified like a text frame, an invalid one ends the session.
+      Utf8Kind kind = ClassifyUtf8(event.data.data(), event.data.size());
+      InspectorStats* stats = transport->stats_;
+      StatsAdd(&stats->text_messages_in, 1);
+      if (kind == Utf8Kind::kInvalid) {
+        StatsAdd(&stats->text_invalid_messages_in, 1);
+        transport->EndSession(event.session_id);
+        break;
+      }
+      if (kind == Utf8Kind::kAscii)
+        StatsAdd(&stats->text_ascii_messages_in, 1);
+      transport->delegate_->MessageReceived(event.session_id,
+                                            std::move(event.data),
+                                            kind == Utf8Kind::kAscii);
+      break;
+    }
+    case EventType::kDisconnect:
+      transport->EndSession(event.session_id);
+      break;
+    }
+  }
+}
+
+// static
+void LoopbackTransport::ClosedCallback(uv_handle_t* handle) {
+  LoopbackTransport* transport = static_cast<LoopbackTransport*>(handle->data);
+  if (transport->stop_callback_ != nullptr)
+    transport->stop_callback_(transport);
+  transport->delegate_->ServerDone();
+}
+
+}  // namespace inspector
@@ -0,0 +1,116 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+#ifndef SRC_INSPECTOR_LOOPBACK_H_
+#define SRC_INSPECTOR_LOOPBACK_H_
+
+#include "inspector_options.h"
+#include "inspector_socket_server.h"
+#include "inspector_stats.h"
+#include "uv.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace inspector {
+
+// Transport without sockets, selected with TransportType::kLoopback in
+// InspectorOptions::transport. The embedder injects frontend
+// messages and collects what the sessions send from memory, so queueing,
+// transcoding and dispatch can be measured without the network.
+class LoopbackTransport {
+ public:
+  using ServerCallback = void (*)(LoopbackTransport*);
+  LoopbackTransport(SocketServerDelegate* delegate,
+                    uv_loop_t* loop,
+                    const std::string& host,
+                    int port,
+                    const InspectorOptions& options,
+                    InspectorStats* stats,
+                    FILE* out = stderr);
+  ~LoopbackTransport();
+
+  // Same surface as InspectorSocketServer, called on the IO thread.
+  bool Start(std::string &debugURL);
+  void Stop(ServerCallback callback);
+  void Send(int session_id, std::string message);
+  void TerminateConnections();
+  void Cork() {}
+  void Uncork() {}
+  int Port() const { return 0; }
+  // Connect() leaves checking the target to the delegate.
+  void AddTarget(const std::string& id, const std::string& title,
+                 const std::string& url) {}
+  void RemoveTarget(const std::string& id) {}
+
+  // Called by the embedder from any thread, delivered on the IO thread in
+  // order. Messages for a session the delegate declined are dropped.
+  int Connect(const std::string& target_id);
+  void Inject(int session_id, std::string message);
+  void Disconnect(int session_id);
+  // Waits up to timeout_ms for count messages to be sent, then moves all
+  // sent so far to messages. Returns false on timeout.
+  bool TakeSent(size_t count, unsigned int timeout_ms,
+                std::vector<std::pair<int, std::string>>* messages);
+
+ private:
+  enum class EventType {kConnect, kMessage, kDisconnect};
+  struct Event {
+    EventType type;
+    int session_id;
+    std::string data;
+  };
+
+  void Post(EventType type, int session_id, std::string data);
+  void EndSession(int session_id);
+  void CloseIfDone();
+  static void EventsCallback(uv_async_t* async);
+  static void ClosedCallback(uv_handle_t* handle);
+
+  SocketServerDelegate* const delegate_;
+  uv_loop_t* loop_;
+  InspectorStats* const stats_;
+  uv_async_t events_async_;
+  std::atomic<int> next_session_id_;
+  // IO thread only.
+  std::set<int> sessions_;
+  bool stopping_;
+  ServerCallback stop_callback_;
+
+  std::mutex events_lock_;
+  std::vector<Event> events_;
+  // Set once events_async_ is being closed, later posts are dropped.
+  bool closing_;
+
+  std::mutex sent_lock_;
+  std::condition_variable sent_cond_;
+  std::vector<std::pair<int, std::string>> sent_;
+};
+
+}  // namespace inspector
+
+#endif  // SRC_INSPECTOR_LOOPBACK_H_
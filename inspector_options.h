@@ -0,0 +1,125 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+#ifndef SRC_INSPECTOR_OPTIONS_H_
+#define SRC_INSPECTOR_OPTIONS_H_
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace inspector {
+
+// What to do when a frontend does not read messages as fast as they are
+// produced, see InspectorOptions::write_queue_high_watermark.
+enum class BackpressurePolicy {
+  // Hold the main thread in SendMessageToFrontend() until the queue drains.
+  kBlock,
+  // Drop notifications whose method is listed in droppable_methods.
+  kDropNotifications,
+  // Close the session.
+  kDisconnect
+};
+
+// Which transport InspectorIo runs on its thread.
+enum class TransportType {
+  // WebSocket server on TCP, or on InspectorOptions::unix_socket_path.
+  kSocket,
+  // LoopbackTransport: messages are injected in process, for benchmarks.
+  kLoopback,
+  // ShmRingTransport: message rings in shared memory, for a collector
+  // process on the same host. Linux only.
+  kSharedMemory
+};
+
+// Tunables for the inspector transport. Set through Agent::SetOptions()
+// before Agent::Prepare(); the defaults match the previous behaviour except
+// where noted.
+struct InspectorOptions {
+  // Largest message accepted from the frontend after decompression and
+  // reassembly of fragments.
+  size_t max_message_size = 256 * 1024 * 1024;
+  // Outgoing messages larger than this are split into fragments of at most
+  // this many bytes. 0 sends every message as a single frame.
+  size_t fragment_size = 0;
+  // Limits for frames gathered into a single write while the outgoing
+  // queue is drained.
+  size_t cork_max_bytes = 256 * 1024;
+  size_t cork_max_frames = 64;
+  // Bytes queued for a session, but not yet accepted by the socket, at which
+  // backpressure_policy applies until the queue is down to the low
+  // watermark again. Previously the queue was unbounded.
+  size_t write_queue_high_watermark = 16 * 1024 * 1024;
+  size_t write_queue_low_watermark = 4 * 1024 * 1024;
+  BackpressurePolicy backpressure_policy = BackpressurePolicy::kBlock;
+  // Notifications dropped under BackpressurePolicy::kDropNotifications.
+  std::vector<std::string> droppable_methods = {
+    "Runtime.consoleAPICalled",
+    "Log.entryAdded"
+  };
+  // Requests for these methods are dispatched ahead of others waiting on the
+  // main thread, e.g. a pause behind a batch of property requests. Their
+  // order against other requests must not matter. Empty turns this off.
+  std::vector<std::string> priority_methods = {
+    "Debugger.pause",
+    "Debugger.resume",
+    "Debugger.stepInto",
+    "Debugger.stepOut",
+    "Debugger.stepOver",
+    "Runtime.terminateExecution"
+  };
+  // Sessions are pinged this often to keep intermediaries from dropping
+  // idle connections and to measure the round trip. 0 disables pings,
+  // which used to be the only behaviour.
+  unsigned int ping_interval_ms = 30000;
+  // Listen on this Unix domain socket instead of TCP host and port, for
+  // debuggers on the same host. A name starting with '@' is bound in the
+  // Linux abstract namespace, on Windows this is a named pipe path such as
+  // \\.\pipe\v8inspector. Targets are then announced as
+  // ws+unix://<path>:/<target>. Empty listens on TCP.
+  std::string unix_socket_path;
+  TransportType transport = TransportType::kSocket;
+  // Bytes in each direction's ring for TransportType::kSharedMemory, a
+  // power of two. Larger messages are passed in fragments.
+  size_t shm_ring_size = 8 * 1024 * 1024;
+  // Wake an idle main thread for incoming messages through uv_default_loop()
+  // instead of a platform task, for embedders that run the libuv loop rather
+  // than pumping the V8 platform. Previously both were always used.
+  bool wake_uv_loop = false;
+
+  // permessage-deflate (RFC 7692). Only used if the frontend offers it.
+  bool deflate_enabled = true;
+  // LZ77 window for both directions, 9..15. Smaller windows use less memory
+  // per session at the cost of compression ratio.
+  int deflate_window_bits = 15;
+  // zlib compression level, 1..9.
+  int deflate_level = 6;
+  // Outgoing messages shorter than this are sent uncompressed.
+  size_t deflate_threshold = 1024;
+  // Keep the LZ77 dictionary between messages. Disabling it lowers memory
+  // and lets each message be inflated on its own, but compresses worse.
+  bool deflate_context_takeover = true;
+};
+
+}  // namespace inspector
+
+#endif  // SRC_INSPECTOR_OPTIONS_H_
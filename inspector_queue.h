@@ -0,0 +1,194 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+#ifndef SRC_INSPECTOR_QUEUE_H_
+#define SRC_INSPECTOR_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace inspector {
+
+// Queue for any number of producer threads and one consumer thread, on a
+// bounded ring of preallocated slots. A producer claims a slot with a
+// compare-and-swap on the tail and publishes it by bumping the slot's
+// sequence number, so pushes neither allocate nor wait on each other or on
+// the consumer.
+//
+// Neither side may block on the other: the IO thread must go on serving
+// sockets while the main thread runs JavaScript, and InspectorIo::Stop()
+// joins the IO thread without dispatching. So a push that finds the ring
+// full goes to an overflow list behind a mutex instead, and later pushes
+// follow it there until the consumer has taken the list. The ring is sized
+// for bursts, see kDefaultCapacity; the overflow is the slow path. Each
+// producer's entries come out in the order it pushed them.
+template <typename T>
+class AtomicQueue {
+ public:
+  typedef T value_type;
+  static const size_t kDefaultCapacity = 1024;
+
+  // capacity is rounded up to a power of two.
+  explicit AtomicQueue(size_t capacity = kDefaultCapacity)
+      : mask_(RoundUpToPowerOfTwo(capacity) - 1),
+        slots_(new Slot[mask_ + 1]),
+        tail_(0), overflowing_(false), head_(0), taken_limit_(0) {
+    for (size_t i = 0; i <= mask_; i++)
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  ~AtomicQueue() { delete[] slots_; }
+
+  // Any thread.
+  void Push(T value) {
+    // seq_cst loads and stores below, so that a consumer that clears its
+    // wakeup flag and then calls Pending() either sees the entry or has its
+    // flag seen by the producer; see InspectorIo::DispatchMessages.
+    if (!overflowing_.load(std::memory_order_seq_cst)) {
+      size_t position = tail_.load(std::memory_order_relaxed);
+      for (;;) {
+        Slot& slot = slots_[position & mask_];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t lag = static_cast<intptr_t>(sequence - position);
+        if (lag < 0)
+          break;  // Full, the slot still holds an entry from a lap ago
+        if (lag > 0) {
+          position = tail_.load(std::memory_order_relaxed);
+        } else if (tail_.compare_exchange_weak(position, position + 1,
+                                               std::memory_order_seq_cst,
+                                               std::memory_order_relaxed)) {
+          slot.value = std::move(value);
+          slot.sequence.store(position + 1, std::memory_order_seq_cst);
+          return;
+        }
+      }
+    }
+    std::lock_guard<std::mutex> lock(overflow_lock_);
+    overflow_.push_back(std::move(value));
+    // Only the consumer clears it, behind the lock.
+    if (!overflowing_.load(std::memory_order_relaxed))
+      overflowing_.store(true, std::memory_order_seq_cst);
+  }
+  // Consumer thread only. Moves the oldest entry to value, returns false if
+  // there is none.
+  bool Pop(T* value) {
+    bool taken;
+    T* next = Next(&taken);
+    if (next == nullptr)
+      return false;
+    *value = std::move(*next);
+    if (taken) {
+      taken_.pop_front();
+    } else {
+      slots_[head_ & mask_].sequence.store(head_ + mask_ + 1,
+                                           std::memory_order_release);
+      head_++;
+    }
+    return true;
+  }
+  // Consumer thread only. The oldest entry, left in the queue, or nullptr.
+  T* Front() {
+    bool taken;
+    return Next(&taken);
+  }
+  // Consumer thread only. True if there is an entry to pop.
+  bool Pending() const {
+    return !taken_.empty() ||
+           slots_[head_ & mask_].sequence.load(std::memory_order_seq_cst) ==
+               head_ + 1 ||
+           overflowing_.load(std::memory_order_seq_cst);
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  AtomicQueue(const AtomicQueue&) = delete;
+  AtomicQueue& operator=(const AtomicQueue&) = delete;
+
+  static size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t result = 2;
+    while (result < n)
+      result <<= 1;
+    return result;
+  }
+
+  // The next entry and whether it is in taken_ rather than the ring.
+  T* Next(bool* taken) {
+    for (;;) {
+      Slot& slot = slots_[head_ & mask_];
+      if (!taken_.empty()) {
+        // Slots claimed before the overflow was taken hold older entries.
+        // Their producers are between claiming and publishing.
+        if (head_ == taken_limit_) {
+          *taken = true;
+          return &taken_.front();
+        }
+        while (slot.sequence.load(std::memory_order_acquire) != head_ + 1)
+          std::this_thread::yield();
+        *taken = false;
+        return &slot.value;
+      }
+      if (slot.sequence.load(std::memory_order_acquire) == head_ + 1) {
+        *taken = false;
+        return &slot.value;
+      }
+      if (!overflowing_.load(std::memory_order_seq_cst))
+        return nullptr;
+      TakeOverflow();
+    }
+  }
+
+  void TakeOverflow() {
+    std::lock_guard<std::mutex> lock(overflow_lock_);
+    // A producer that sees the flag cleared claims a slot past the limit.
+    taken_limit_ = tail_.load(std::memory_order_seq_cst);
+    taken_.swap(overflow_);
+    overflowing_.store(false, std::memory_order_seq_cst);
+  }
+
+  const size_t mask_;
+  Slot* const slots_;
+  // Keeps what producers write and what the consumer writes on separate
+  // cache lines.
+  char producer_line_[64];
+  std::atomic<size_t> tail_;
+  std::atomic<bool> overflowing_;
+  std::mutex overflow_lock_;
+  std::deque<T> overflow_;  // Behind overflow_lock_
+  char consumer_line_[64];
+  // Consumer only.
+  size_t head_;
+  // Overflow entries, to come after the ring up to taken_limit_.
+  std::deque<T> taken_;
+  size_t taken_limit_;
+};
+
+}  // namespace inspector
+
+#endif  // SRC_INSPECTOR_QUEUE_H_
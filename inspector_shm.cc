@@ -0,0 +1,432 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+#include "inspector_shm.h"
+#include "inspector_utf8.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace inspector {
+
+extern FILE *gLogStream;
+
+namespace {
+
+static_assert(sizeof(ShmRingIndex) == 128, "ShmRingIndex layout");
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "The rings need lock free 64 bit atomics");
+
+size_t RecordSize(size_t length) {
+  return sizeof(ShmRecordHeader) + ((length + 7) & ~static_cast<size_t>(7));
+}
+
+void CopyToRing(char* ring, size_t ring_size, uint64_t position,
+                const char* data, size_t len) {
+  if (len == 0)
+    return;
+  size_t offset = static_cast<size_t>(position & (ring_size - 1));
+  size_t first = std::min(len, ring_size - offset);
+  memcpy(ring + offset, data, first);
+  memcpy(ring, data + first, len - first);
+}
+
+void CopyFromRing(const char* ring, size_t ring_size, uint64_t position,
+                  char* data, size_t len) {
+  if (len == 0)
+    return;
+  size_t offset = static_cast<size_t>(position & (ring_size - 1));
+  size_t first = std::min(len, ring_size - offset);
+  memcpy(data, ring + offset, first);
+  memcpy(data + first, ring, len - first);
+}
+
+void Notify(int eventfd) {
+#ifdef __linux__
+  uint64_t one = 1;
+  // EAGAIN would mean the counter is about to overflow, so it is set.
+  ssize_t written = write(eventfd, &one, sizeof(one));
+  (void) written;
+#endif
+}
+
+}  // namespace
+
+ShmRingTransport::ShmRingTransport(SocketServerDelegate* delegate,
+                                   uv_loop_t* loop,
+                                   const std::string& host,
+                                   int port,
+                                   const InspectorOptions& options,
+                                   InspectorStats* stats,
+                                   FILE* out) : delegate_(delegate),
+                                                loop_(loop),
+                                                options_(options),
+                                                stats_(stats),
+                                                out_(out),
+                                                segment_(nullptr),
+                                                segment_size_(0),
+                                                ring_size_(0),
+                                                memfd_(-1),
+                                                inspector_eventfd_(-1),
+                                                collector_eventfd_(-1),
+                                                polling_(false),
+                                                next_session_id_(0),
+                                                session_id_(-1),
+                                                corked_(false),
+                                                stopping_(false),
+                                                stop_callback_(nullptr),
+                                                outgoing_offset_(0),
+                                                detach_pending_(false),
+                                                refusals_pending_(0),
+                                                written_(false) {
+}
+
+ShmRingTransport::~ShmRingTransport() {
+  Release();
+}
+
+bool ShmRingTransport::Start(std::string &debugURL) {
+#ifdef __linux__
+  ring_size_ = options_.shm_ring_size;
+  if (ring_size_ < 4096 || (ring_size_ & (ring_size_ - 1)) != 0) {
+    if (out_ != NULL) {
+      fprintf(out_, "v8inspector: shm_ring_size must be a power of two of "
+                    "at least 4096\n");
+      fflush(out_);
+    }
+    return false;
+  }
+  segment_size_ = kShmDataOffset + 2 * ring_size_;
+  int err = 0;
+  memfd_ = memfd_create("v8inspector", MFD_CLOEXEC);
+  if (memfd_ < 0 || ftruncate(memfd_, segment_size_) != 0)
+    err = -errno;
+  if (err == 0) {
+    void* segment = mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, memfd_, 0);
+    if (segment == MAP_FAILED)
+      err = -errno;
+    else
+      segment_ = static_cast<char*>(segment);
+  }
+  if (err == 0) {
+    inspector_eventfd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    collector_eventfd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (inspector_eventfd_ < 0 || collector_eventfd_ < 0)
+      err = -errno;
+  }
+  if (err == 0)
+    err = uv_poll_init(loop_, &poll_, inspector_eventfd_);
+  if (err != 0) {
+    if (out_ != NULL) {
+      fprintf(out_, "v8inspector: Starting shared memory transport failed: "
+                    "%s\n", uv_strerror(err));
+      fflush(out_);
+    }
+    Release();
+    return false;
+  }
+
+  new (ring_index(kShmToInspectorIndex)) ShmRingIndex();
+  new (ring_index(kShmToCollectorIndex)) ShmRingIndex();
+  ShmSegmentHeader* header = reinterpret_cast<ShmSegmentHeader*>(segment_);
+  header->version = kShmVersion;
+  header->ring_size = ring_size_;
+  header->magic = kShmMagic;
+
+  poll_.data = this;
+  uv_poll_start(&poll_, UV_READABLE, PollCallback);
+  polling_ = true;
+
+  char url[192];
+  snprintf(url, sizeof(url),
+           "shm://%d?memfd=%d&inspector_eventfd=%d&collector_eventfd=%d"
+           "&ring_size=%zu", static_cast<int>(getpid()), memfd_,
+           inspector_eventfd_, collector_eventfd_, ring_size_);
+  if (out_ != NULL) {
+    fprintf(out_, "%s\n", url);
+    fflush(out_);
+  }
+  fprintf(gLogStream, "v8inspector: Debugger rings in shared memory:\n%s\n",
+          url);
+  debugURL = url;
+  return true;
+#else
+  if (out_ != NULL) {
+    fprintf(out_, "v8inspector: The shared memory transport needs Linux\n");
+    fflush(out_);
+  }
+  return false;
+#endif  // __linux__
+}
+
+void ShmRingTransport::Release() {
+#ifdef __linux__
+  if (segment_ != nullptr)
+    munmap(segment_, segment_size_);
+  segment_ = nullptr;
+  for (int* fd : {&memfd_, &inspector_eventfd_, &collector_eventfd_}) {
+    if (*fd >= 0)
+      close(*fd);
+    *fd = -1;
+  }
+#endif
+}
+
+void ShmRingTransport::Stop(ServerCallback callback) {
+  stopping_ = true;
+  stop_callback_ = callback;
+  CloseIfDone();
+}
+
+void ShmRingTransport::Send(int session_id, std::string message) {
+  if (session_id != session_id_)
+    return;
+  outgoing_.push_back(std::move(message));
+  if (!corked_)
+    FlushOutgoing();
+}
+
+void ShmRingTransport::Uncork() {
+  corked_ = false;
+  FlushOutgoing();
+}
+
+void ShmRingTransport::TerminateConnections() {
+  if (session_id_ >= 0)
+    EndSession(true);
+}
+
+bool ShmRingTransport::WriteRecord(uint32_t type, const char* data,
+                                   size_t len) {
+  ShmRingIndex* index = ring_index(kShmToCollectorIndex);
+  char* ring = segment_ + kShmDataOffset + ring_size_;
+  uint64_t head = index->head.load(std::memory_order_relaxed);
+  uint64_t tail = index->tail.load(std::memory_order_acquire);
+  if (ring_size_ - (head - tail) < RecordSize(len))
+    return false;
+  ShmRecordHeader header = { static_cast<uint32_t>(len), type };
+  CopyToRing(ring, ring_size_, head,
+             reinterpret_cast<const char*>(&header), sizeof(header));
+  CopyToRing(ring, ring_size_, head + sizeof(header), data, len);
+  index->head.store(head + RecordSize(len), std::memory_order_release);
+  written_ = true;
+  return true;
+}
+
+void ShmRingTransport::FlushOutgoing() {
+  if (segment_ == nullptr)
+    return;
+  if (detach_pending_ && WriteRecord(kShmDetach, nullptr, 0))
+    detach_pending_ = false;
+  while (refusals_pending_ > 0 &&
+         WriteRecord(kShmAttachRefused, nullptr, 0)) {
+    refusals_pending_--;
+  }
+  bool full = false;
+  while (!outgoing_.empty()) {
+    const std::string& message = outgoing_.front();
+    const char* data = message.data() + outgoing_offset_;
+    size_t remaining = message.size() - outgoing_offset_;
+    if (WriteRecord(kShmMessage, data, remaining)) {
+      StatsAdd(&stats_->shm_messages_out, 1);
+      StatsAdd(&stats_->shm_bytes_out, message.size());
+      outgoing_.pop_front();
+      outgoing_offset_ = 0;
+      continue;
+    }
+    // Only a message too large for the ring is split, others wait for
+    // the collector to catch up.
+    ShmRingIndex* index = ring_index(kShmToCollectorIndex);
+    uint64_t used = index->head.load(std::memory_order_relaxed) -
+                    index->tail.load(std::memory_order_acquire);
+    size_t space = ring_size_ - used;
+    size_t part = space > sizeof(ShmRecordHeader) ?
+        (space - sizeof(ShmRecordHeader)) & ~static_cast<size_t>(7) : 0;
+    if (RecordSize(remaining) <= ring_size_ || part == 0) {
+      full = true;
+      break;
+    }
+    WriteRecord(kShmFragment, data, part);
+    outgoing_offset_ += part;
+  }
+  if (full)
+    StatsAdd(&stats_->shm_ring_full, 1);
+  if (written_) {
+    written_ = false;
+    Notify(collector_eventfd_);
+  }
+}
+
+void ShmRingTransport::ReadIncoming() {
+  ShmRingIndex* index = ring_index(kShmToInspectorIndex);
+  const char* ring = segment_ + kShmDataOffset;
+  uint64_t tail = index->tail.load(std::memory_order_relaxed);
+  uint64_t head = index->head.load(std::memory_order_acquire);
+  bool consumed = false;
+  std::string control;
+  while (segment_ != nullptr && head - tail >= sizeof(ShmRecordHeader)) {
+    ShmRecordHeader header;
+    CopyFromRing(ring, ring_size_, tail,
+                 reinterpret_cast<char*>(&header), sizeof(header));
+    size_t record = RecordSize(header.length);
+    if (record > ring_size_) {
+      // Corrupt, there is no way to find the next record.
+      tail = head;
+      consumed = true;
+      if (session_id_ >= 0)
+        EndSession(true);
+      break;
+    }
+    if (record > head - tail)
+      break;
+    uint64_t payload = tail + sizeof(ShmRecordHeader);
+    tail += record;
+    consumed = true;
+    if (header.type == kShmMessage || header.type == kShmFragment) {
+      size_t start = incoming_.size();
+      if (start + header.length > options_.max_message_size) {
+        incoming_.clear();
+        if (session_id_ >= 0)
+          EndSession(true);
+        continue;
+      }
+      incoming_.resize(start + header.length);
+      CopyFromRing(ring, ring_size_, payload, &incoming_[start],
+                   header.length);
+      if (header.type == kShmMessage) {
+        HandleRecord(header.type, incoming_.data(), incoming_.size());
+        incoming_.clear();
+      }
+    } else {
+      control.resize(header.length);
+      CopyFromRing(ring, ring_size_, payload, &control[0], header.length);
+      HandleRecord(header.type, control.data(), control.size());
+    }
+  }
+  if (consumed) {
+    index->tail.store(tail, std::memory_order_release);
+    Notify(collector_eventfd_);
+  }
+}
+
+void ShmRingTransport::HandleRecord(uint32_t type, const char* data,
+                                    size_t len) {
+  switch (type) {
+  case kShmMessage: {
+    if (session_id_ < 0)
+      return;
+    // Checked like a text frame, invalid UTF-8 ends the session.
+    Utf8Kind kind = ClassifyUtf8(data, len);
+    if (kind == Utf8Kind::kInvalid) {
+      EndSession(true);
+      return;
+    }
+    StatsAdd(&stats_->shm_messages_in, 1);
+    delegate_->MessageReceived(session_id_, std::string(data, len),
+                               kind == Utf8Kind::kAscii);
+    return;
+  }
+  case kShmAttach: {
+    std::string target_id(data, len);
+    std::vector<std::string> targets = delegate_->GetTargetIds();
+    if (target_id.empty() && !targets.empty())
+      target_id = targets[0];
+    bool exists = std::find(targets.begin(), targets.end(), target_id) !=
+                  targets.end();
+    int session_id = next_session_id_;
+    if (session_id_ < 0 && !stopping_ && exists &&
+        delegate_->StartSession(session_id, target_id)) {
+      next_session_id_++;
+      session_id_ = session_id;
+    } else {
+      refusals_pending_++;
+      FlushOutgoing();
+    }
+    return;
+  }
+  case kShmDetach:
+    if (session_id_ >= 0)
+      EndSession(false);
+    return;
+  default:
+    return;
+  }
+}
+
+void ShmRingTransport::EndSession(bool notify_collector) {
+  int session_id = session_id_;
+  session_id_ = -1;
+  outgoing_.clear();
+  outgoing_offset_ = 0;
+  incoming_.clear();
+  delegate_->EndSession(session_id);
+  if (notify_collector) {
+    detach_pending_ = true;
+    FlushOutgoing();
+  }
+  CloseIfDone();
+}
+
+// Like the socket server, stopping waits for the session to end.
+void ShmRingTransport::CloseIfDone() {
+  if (!stopping_ || session_id_ >= 0 || !polling_)
+    return;
+  polling_ = false;
+  uv_close(reinterpret_cast<uv_handle_t*>(&poll_), ClosedCallback);
+}
+
+// static
+void ShmRingTransport::PollCallback(uv_poll_t* poll, int status,
+                                    int events) {
+  ShmRingTransport* transport = static_cast<ShmRingTransport*>(poll->data);
+  if (status < 0)
+    return;
+#ifdef __linux__
+  uint64_t count;
+  ssize_t received = read(transport->inspector_eventfd_, &count,
+                          sizeof(count));
+  (void) received;
+#endif
+  transport->ReadIncoming();
+  transport->FlushOutgoing();
+}
+
+// static
+void ShmRingTransport::ClosedCallback(uv_handle_t* handle) {
+  ShmRingTransport* transport = static_cast<ShmRingTransport*>(handle->data);
+  if (transport->stop_callback_ != nullptr)
+    transport->stop_callback_(transport);
+  transport->delegate_->ServerDone();
+}
+
+}  // namespace inspector
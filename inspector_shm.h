@@ -0,0 +1,172 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+#ifndef SRC_INSPECTOR_SHM_H_
+#define SRC_INSPECTOR_SHM_H_
+
+#include "inspector_options.h"
+#include "inspector_socket_server.h"
+#include "inspector_stats.h"
+#include "uv.h"
+
+#include <atomic>
+#include <deque>
+#include <stdint.h>
+#include <string>
+
+namespace inspector {
+
+// Layout of the segment shared with the collector, both sides on the same
+// host and so of the same byte order:
+//
+//   0                         ShmSegmentHeader
+//   kShmToInspectorIndex      ShmRingIndex of the collector -> inspector ring
+//   kShmToCollectorIndex      ShmRingIndex of the inspector -> collector ring
+//   kShmDataOffset            collector -> inspector data, ring_size bytes
+//   + ring_size               inspector -> collector data, ring_size bytes
+//
+// head and tail count bytes written and read since the start, the offset in
+// the data is the count modulo ring_size. A ring holds records of a
+// ShmRecordHeader and length bytes of payload, padded to a multiple of 8;
+// records wrap around the end of the data.
+//
+// Each side owns an eventfd it waits on. Writing records, or reading some
+// from a ring, is followed by a write to the other side's eventfd.
+const uint32_t kShmMagic = 0x52493856;  // "V8IR"
+const uint32_t kShmVersion = 1;
+const size_t kShmToInspectorIndex = 64;
+const size_t kShmToCollectorIndex = 192;
+const size_t kShmDataOffset = 4096;
+
+struct ShmSegmentHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t ring_size;
+};
+
+struct ShmRingIndex {
+  alignas(64) std::atomic<uint64_t> head;  // Written by the producer
+  alignas(64) std::atomic<uint64_t> tail;  // Written by the consumer
+};
+
+enum ShmRecordType : uint32_t {
+  // A protocol message, or the last part of one.
+  kShmMessage = 0,
+  // A part of a message that did not fit the ring, more follow.
+  kShmFragment = 1,
+  // Collector -> inspector: start a session, the payload is the target id
+  // or empty for the first target.
+  kShmAttach = 2,
+  // Either way: the session ended.
+  kShmDetach = 3,
+  // Inspector -> collector: a kShmAttach was refused, e.g. for an unknown
+  // target or while a session is attached. That session goes on.
+  kShmAttachRefused = 4
+};
+
+struct ShmRecordHeader {
+  uint32_t length;
+  uint32_t type;
+};
+
+// Transport for a collector process on the same host, selected with
+// TransportType::kSharedMemory in InspectorOptions::transport. There is no
+// HTTP discovery and no WebSocket framing: messages are copied into a pair
+// of single producer, single consumer rings in a memfd. The
+// "shm://<pid>?memfd=..." line written to the URL file names the memfd and
+// eventfd descriptors, which the collector takes over with pidfd_getfd(2).
+// One session at a time.
+class ShmRingTransport {
+ public:
+  using ServerCallback = void (*)(ShmRingTransport*);
+  ShmRingTransport(SocketServerDelegate* delegate,
+                   uv_loop_t* loop,
+                   const std::string& host,
+                   int port,
+                   const InspectorOptions& options,
+                   InspectorStats* stats,
+                   FILE* out = stderr);
+  ~ShmRingTransport();
+
+  bool Start(std::string &debugURL);
+  void Stop(ServerCallback callback);
+  void Send(int session_id, std::string message);
+  void TerminateConnections();
+  // Messages sent in between are announced with a single eventfd write.
+  void Cork() { corked_ = true; }
+  void Uncork();
+  int Port() const { return 0; }
+  // An attach looks the target up with the delegate, which keeps the list.
+  void AddTarget(const std::string& id, const std::string& title,
+                 const std::string& url) {}
+  void RemoveTarget(const std::string& id) {}
+
+ private:
+  ShmRingIndex* ring_index(size_t offset) {
+    return reinterpret_cast<ShmRingIndex*>(segment_ + offset);
+  }
+  void ReadIncoming();
+  void HandleRecord(uint32_t type, const char* data, size_t len);
+  void FlushOutgoing();
+  bool WriteRecord(uint32_t type, const char* data, size_t len);
+  void EndSession(bool notify_collector);
+  void CloseIfDone();
+  void Release();
+  static void PollCallback(uv_poll_t* poll, int status, int events);
+  static void ClosedCallback(uv_handle_t* handle);
+
+  SocketServerDelegate* const delegate_;
+  uv_loop_t* loop_;
+  const InspectorOptions options_;
+  InspectorStats* const stats_;
+  FILE* out_;
+  char* segment_;
+  size_t segment_size_;
+  size_t ring_size_;
+  int memfd_;
+  // Waited on by the inspector and by the collector.
+  int inspector_eventfd_;
+  int collector_eventfd_;
+  uv_poll_t poll_;
+  bool polling_;
+  int next_session_id_;
+  int session_id_;  // -1 without a session
+  bool corked_;
+  bool stopping_;
+  ServerCallback stop_callback_;
+  // Parts of the message being received.
+  std::string incoming_;
+  // Messages waiting for room in the ring, the first one partly written up
+  // to outgoing_offset_.
+  std::deque<std::string> outgoing_;
+  size_t outgoing_offset_;
+  // A kShmDetach record is owed to the collector.
+  bool detach_pending_;
+  // kShmAttachRefused records owed to the collector.
+  size_t refusals_pending_;
+  // Records were written since the collector was last notified.
+  bool written_;
+};
+
+}  // namespace inspector
+
+#endif  // SRC_INSPECTOR_SHM_H_
@@ -23,16 +23,34 @@
 #include "inspector_socket.h"
 
 #include "base64.h"
+#include "inspector_utf8.h"
 
 #include "openssl/sha.h"  // Sha-1 hash
+#include "zlib.h"
 
 #include <string.h>
+#include <algorithm>
 #include <vector>
 #include <cassert>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define WS_UNMASK_VECTOR_WIDTH 32
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WS_UNMASK_VECTOR_WIDTH 16
+#else
+#define WS_UNMASK_VECTOR_WIDTH 0
+#endif
+
 
 #define ACCEPT_KEY_LENGTH base64_encoded_size(20)
-#define BUFFER_GROWTH_CHUNK_SIZE 1024
+#define BUFFER_GROWTH_CHUNK_SIZE static_cast<size_t>(1024)
+// Reads go into the free tail of the receive buffer as long as it has at
+// least this much room, otherwise the buffer grows first.
+#define MIN_READ_SIZE 4096
+#define MAX_FRAME_HEADER_LENGTH 10
 
 #define DUMP_READS 0
 #define DUMP_WRITES 0
@@ -72,15 +90,351 @@ static void dump_hex(const char* buf, size_t len) {
 }
 #endif
 
-static void remove_from_beginning(std::vector<char>* buffer, size_t count) {
-  buffer->erase(buffer->begin(), buffer->begin() + count);
+ReadBufferPool::~ReadBufferPool() {
+  for (char* block : free_blocks_)
+    delete[] block;
+}
+
+char* ReadBufferPool::Acquire() {
+  if (free_blocks_.empty()) {
+    StatsAdd(&stats_->read_pool_misses, 1);
+    return new char[kBlockSize];
+  }
+  StatsAdd(&stats_->read_pool_hits, 1);
+  char* block = free_blocks_.back();
+  free_blocks_.pop_back();
+  return block;
+}
+
+void ReadBufferPool::Release(char* block) {
+  if (free_blocks_.size() < kMaxFreeBlocks)
+    free_blocks_.push_back(block);
+  else
+    delete[] block;
+}
+
+void ReceiveBuffer::EnsureWritable(size_t len) {
+  if (capacity_ - write_pos_ >= len)
+    return;
+  // Out of room at the end - reclaim the consumed prefix before growing.
+  size_t live = size();
+  if (read_pos_ > 0) {
+    if (live > 0)
+      memmove(storage_, storage_ + read_pos_, live);
+    read_pos_ = 0;
+    write_pos_ = live;
+  }
+  if (capacity_ - write_pos_ < len) {
+    size_t capacity = std::max(capacity_ * 2, BUFFER_GROWTH_CHUNK_SIZE);
+    if (capacity < write_pos_ + len)
+      capacity = write_pos_ + len;
+    char* storage = new char[capacity];
+    if (live > 0)
+      memcpy(storage, storage_, live);
+    clear();
+    storage_ = storage;
+    capacity_ = capacity;
+    write_pos_ = live;
+  }
+}
+
+void ReceiveBuffer::Append(const char* data, size_t len) {
+  if (len == 0)
+    return;
+  EnsureWritable(len);
+  memcpy(storage_ + write_pos_, data, len);
+  write_pos_ += len;
+}
+
+uv_buf_t ReceiveBuffer::PrepareRead(size_t len, ReadBufferPool* pool) {
+  if (storage_ == nullptr && pool != nullptr &&
+      len <= ReadBufferPool::kBlockSize) {
+    storage_ = pool->Acquire();
+    capacity_ = ReadBufferPool::kBlockSize;
+    pool_ = pool;
+  } else if (capacity_ - write_pos_ < MIN_READ_SIZE) {
+    EnsureWritable(len);
+  }
+  return uv_buf_init(storage_ + write_pos_, capacity_ - write_pos_);
+}
+
+void ReceiveBuffer::Consume(size_t count) {
+  assert(count <= size());
+  read_pos_ += count;
+  if (read_pos_ == write_pos_) {
+    // Nothing left to parse, so the next read starts at the front for free.
+    read_pos_ = 0;
+    write_pos_ = 0;
+  }
+}
+
+void ReceiveBuffer::clear() {
+  if (pool_ != nullptr)
+    pool_->Release(storage_);
+  else
+    delete[] storage_;
+  storage_ = nullptr;
+  capacity_ = 0;
+  read_pos_ = 0;
+  write_pos_ = 0;
+  pool_ = nullptr;
+}
+
+// permessage-deflate (RFC 7692)
+
+// Negotiated parameters, see negotiate_permessage_deflate().
+struct ws_deflate_params {
+  int server_window_bits;
+  int client_window_bits;
+  bool server_no_context_takeover;
+  bool client_no_context_takeover;
+};
+
+struct ws_deflate_state_s {
+  ws_deflate_params params;
+  z_stream deflater;
+  z_stream inflater;
+};
+
+// Every message compressed with Z_SYNC_FLUSH ends with this empty stored
+// block. The sender strips it and the receiver appends it back.
+static const unsigned char DEFLATE_TRAILER[] = {0x00, 0x00, 0xff, 0xff};
+
+static ws_deflate_state_s* create_deflate_state(
+    const ws_deflate_params& params, int level) {
+  ws_deflate_state_s* state = new ws_deflate_state_s();
+  state->params = params;
+  // Negative window bits select a raw deflate stream without zlib header.
+  if (deflateInit2(&state->deflater, level, Z_DEFLATED,
+                   -params.server_window_bits, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    delete state;
+    return nullptr;
+  }
+  if (inflateInit2(&state->inflater, -params.client_window_bits) != Z_OK) {
+    deflateEnd(&state->deflater);
+    delete state;
+    return nullptr;
+  }
+  return state;
+}
+
+static void free_deflate_state(ws_deflate_state_s* state) {
+  if (state == nullptr)
+    return;
+  deflateEnd(&state->deflater);
+  inflateEnd(&state->inflater);
+  delete state;
+}
+
+static std::string trim(const std::string& str) {
+  size_t begin = str.find_first_not_of(" \t");
+  if (begin == std::string::npos)
+    return std::string();
+  size_t end = str.find_last_not_of(" \t");
+  return str.substr(begin, end - begin + 1);
+}
+
+static void split(const std::string& str, char separator,
+                  std::vector<std::string>* parts) {
+  size_t begin = 0;
+  while (true) {
+    size_t end = str.find(separator, begin);
+    parts->push_back(trim(str.substr(begin, end - begin)));
+    if (end == std::string::npos)
+      break;
+    begin = end + 1;
+  }
+}
+
+// Parses a window bits value, optionally quoted. Returns 0 if invalid.
+static int parse_window_bits(const std::string& value) {
+  std::string digits = value;
+  if (digits.size() >= 2 && digits[0] == '"' &&
+      digits[digits.size() - 1] == '"') {
+    digits = digits.substr(1, digits.size() - 2);
+  }
+  if (digits.empty() || digits.size() > 2 ||
+      digits.find_first_not_of("0123456789") != std::string::npos) {
+    return 0;
+  }
+  int bits = atoi(digits.c_str());
+  return bits >= 8 && bits <= 15 ? bits : 0;
 }
 
+// Picks the first permessage-deflate offer in the Sec-WebSocket-Extensions
+// header that we can honour. Fills params and the response header value and
+// returns true on success.
+static bool negotiate_permessage_deflate(const std::string& offers,
+                                         const InspectorOptions& options,
+                                         ws_deflate_params* params,
+                                         std::string* response) {
+  // zlib cannot produce raw streams with an 8 bit window, clamp to 9..15.
+  int window_bits = std::min(std::max(options.deflate_window_bits, 9), 15);
+  std::vector<std::string> extensions;
+  split(offers, ',', &extensions);
+  for (const std::string& extension : extensions) {
+    std::vector<std::string> tokens;
+    split(extension, ';', &tokens);
+    if (!StringEqualNoCase(tokens[0].c_str(), "permessage-deflate"))
+      continue;
+    ws_deflate_params offer;
+    offer.server_window_bits = window_bits;
+    offer.client_window_bits = 15;
+    offer.server_no_context_takeover = !options.deflate_context_takeover;
+    offer.client_no_context_takeover = !options.deflate_context_takeover;
+    bool client_window_bits_allowed = false;
+    bool valid = true;
+    for (size_t i = 1; i < tokens.size() && valid; i++) {
+      size_t eq = tokens[i].find('=');
+      std::string name = trim(tokens[i].substr(0, eq));
+      std::string value =
+          eq == std::string::npos ? std::string() : trim(tokens[i].substr(eq + 1));
+      if (name == "server_no_context_takeover") {
+        offer.server_no_context_takeover = true;
+      } else if (name == "client_no_context_takeover") {
+        offer.client_no_context_takeover = true;
+      } else if (name == "server_max_window_bits") {
+        int bits = parse_window_bits(value);
+        // An 8 bit limit cannot be met by zlib, try the next offer.
+        valid = bits >= 9;
+        offer.server_window_bits = std::min(offer.server_window_bits, bits);
+      } else if (name == "client_max_window_bits") {
+        client_window_bits_allowed = true;
+        if (!value.empty()) {
+          int bits = parse_window_bits(value);
+          valid = bits != 0;
+          offer.client_window_bits = bits;
+        }
+      } else {
+        valid = false;
+      }
+    }
+    if (!valid)
+      continue;
+    std::string reply = "permessage-deflate";
+    if (offer.server_no_context_takeover)
+      reply += "; server_no_context_takeover";
+    if (offer.client_no_context_takeover)
+      reply += "; client_no_context_takeover";
+    if (offer.server_window_bits < 15)
+      reply += "; server_max_window_bits=" +
+               std::to_string(offer.server_window_bits);
+    // The client may only be limited if it said it can be.
+    if (client_window_bits_allowed) {
+      offer.client_window_bits =
+          std::max(std::min(offer.client_window_bits, window_bits), 9);
+      if (offer.client_window_bits < 15)
+        reply += "; client_max_window_bits=" +
+                 std::to_string(offer.client_window_bits);
+    }
+    *params = offer;
+    *response = reply;
+    return true;
+  }
+  return false;
+}
+
+// Compresses a whole message into output. Returns false on zlib failure.
+static bool deflate_message(InspectorSocket* inspector,
+                            const std::string& message,
+                            std::string* output) {
+  ws_deflate_state_s* state = inspector->ws_state->deflate;
+  uint64_t start = uv_hrtime();
+  z_stream* strm = &state->deflater;
+  output->resize(deflateBound(strm, message.size()) + 16);
+  strm->next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(message.data()));
+  strm->avail_in = message.size();
+  size_t written = 0;
+  int err;
+  do {
+    if (written == output->size())
+      output->resize(output->size() * 2);
+    strm->next_out = reinterpret_cast<Bytef*>(&(*output)[written]);
+    strm->avail_out = output->size() - written;
+    err = deflate(strm, Z_SYNC_FLUSH);
+    written = output->size() - strm->avail_out;
+  } while (err == Z_OK && strm->avail_out == 0);
+  // Z_BUF_ERROR only means the last call had nothing left to flush.
+  if ((err != Z_OK && err != Z_BUF_ERROR) ||
+      written < sizeof(DEFLATE_TRAILER))
+    return false;
+  output->resize(written - sizeof(DEFLATE_TRAILER));
+  if (state->params.server_no_context_takeover)
+    deflateReset(strm);
+  if (inspector->stats != nullptr) {
+    InspectorStats* stats = inspector->stats;
+    StatsAdd(&stats->deflate_messages, 1);
+    StatsAdd(&stats->deflate_raw_bytes, message.size());
+    StatsAdd(&stats->deflate_compressed_bytes, output->size());
+    StatsAdd(&stats->deflate_time_ns, uv_hrtime() - start);
+  }
+  return true;
+}
+
+static bool inflate_chunk(z_stream* strm, const char* data, size_t len,
+                          size_t limit, std::string* output) {
+  strm->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  strm->avail_in = len;
+  while (strm->avail_in > 0) {
+    size_t written = output->size();
+    if (written >= limit)
+      return false;
+    size_t chunk = std::min(std::max<size_t>(len * 2, 4096), limit - written);
+    output->resize(written + chunk);
+    strm->next_out = reinterpret_cast<Bytef*>(&(*output)[written]);
+    strm->avail_out = chunk;
+    int err = inflate(strm, Z_SYNC_FLUSH);
+    output->resize(output->size() - strm->avail_out);
+    if (err == Z_STREAM_END) {
+      // The peer finished the stream with a BFINAL block and will start a
+      // fresh one for its next message.
+      inflateReset(strm);
+      strm->avail_in = 0;
+    } else if (err != Z_OK && err != Z_BUF_ERROR) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Decompresses a whole message into output. Returns false if the data is
+// corrupt or inflates past InspectorOptions::max_message_size.
+static bool inflate_message(InspectorSocket* inspector,
+                            const char* data, size_t len,
+                            std::string* output) {
+  ws_deflate_state_s* state = inspector->ws_state->deflate;
+  uint64_t start = uv_hrtime();
+  z_stream* strm = &state->inflater;
+  size_t limit = inspector->options->max_message_size;
+  bool ok = inflate_chunk(strm, data, len, limit, output) &&
+            inflate_chunk(strm,
+                          reinterpret_cast<const char*>(DEFLATE_TRAILER),
+                          sizeof(DEFLATE_TRAILER), limit, output);
+  if (ok && state->params.client_no_context_takeover)
+    inflateReset(strm);
+  if (ok && inspector->stats != nullptr) {
+    InspectorStats* stats = inspector->stats;
+    StatsAdd(&stats->inflate_messages, 1);
+    StatsAdd(&stats->inflate_compressed_bytes, len);
+    StatsAdd(&stats->inflate_raw_bytes, output->size());
+    StatsAdd(&stats->inflate_time_ns, uv_hrtime() - start);
+  }
+  return ok;
+}
+
+static void free_write_batch(ws_write_batch_s* batch);
+
 static void dispose_inspector(uv_handle_t* handle) {
   InspectorSocket* inspector = inspector_from_stream(handle);
   inspector_cb close =
       inspector->ws_mode ? inspector->ws_state->close_cb : nullptr;
   inspector->buffer.clear();
+  if (inspector->ws_state != nullptr) {
+    free_deflate_state(inspector->ws_state->deflate);
+    free_write_batch(inspector->ws_state->batch);
+  }
   delete inspector->ws_state;
   inspector->ws_state = nullptr;
   if (close) {
@@ -96,42 +450,6 @@ static void close_connection(InspectorSocket* inspector) {
   }
 }
 
-struct WriteRequest {
-  WriteRequest(InspectorSocket* inspector, const char* data, size_t size)
-      : inspector(inspector)
-      , storage(data, data + size)
-      , buf(uv_buf_init(&storage[0], storage.size())) {}
-
-  static WriteRequest* from_write_req(uv_write_t* req) {
-    return ContainerOf(&WriteRequest::req, req);
-  }
-
-  InspectorSocket* const inspector;
-  std::vector<char> storage;
-  uv_write_t req;
-  uv_buf_t buf;
-};
-
-// Cleanup
-static void write_request_cleanup(uv_write_t* req, int status) {
-  delete WriteRequest::from_write_req(req);
-}
-
-static int write_to_client(InspectorSocket* inspector,
-                           const char* msg,
-                           size_t len,
-                           uv_write_cb write_cb = write_request_cleanup) {
-#if DUMP_WRITES
-  printf("%s (%ld bytes):\n", __FUNCTION__, len);
-  dump_hex(msg, len);
-#endif
-
-  // Freed in write_request_cleanup
-  WriteRequest* wr = new WriteRequest(inspector, msg, len);
-  uv_stream_t* stream = reinterpret_cast<uv_stream_t*>(&inspector->tcp);
-  return uv_write(&wr->req, stream, &wr->buf, 1, write_cb) < 0;
-}
-
 // Constants for hybi-10 frame format.
 
 typedef int OpCode;
@@ -156,69 +474,419 @@ const size_t kTwoBytePayloadLengthField = 126;
 const size_t kEightBytePayloadLengthField = 127;
 const size_t kMaskingKeyWidthInBytes = 4;
 
-static std::vector<char> encode_frame_hybi17(const char* message,
-                                             size_t data_length) {
-  std::vector<char> frame;
-  OpCode op_code = kOpCodeText;
-  frame.push_back(kFinalBit | op_code);
+// Writes the header of an unmasked server frame carrying data_length bytes
+// into header, which must hold MAX_FRAME_HEADER_LENGTH bytes. Returns the
+// number of header bytes written.
+static size_t encode_frame_header_hybi17(size_t data_length, OpCode op_code,
+                                         bool final, bool compressed,
+                                         char* header) {
+  size_t length = 0;
+  header[length++] = (final ? kFinalBit : 0) |
+                     (compressed ? kReserved1Bit : 0) | op_code;
   if (data_length <= kMaxSingleBytePayloadLength) {
-    frame.push_back(static_cast<char>(data_length));
+    header[length++] = static_cast<char>(data_length);
   } else if (data_length <= 0xFFFF) {
-    frame.push_back(kTwoBytePayloadLengthField);
-    frame.push_back((data_length & 0xFF00) >> 8);
-    frame.push_back(data_length & 0xFF);
+    header[length++] = kTwoBytePayloadLengthField;
+    header[length++] = (data_length & 0xFF00) >> 8;
+    header[length++] = data_length & 0xFF;
   } else {
-    frame.push_back(kEightBytePayloadLengthField);
-    char extended_payload_length[8];
-    size_t remaining = data_length;
-    // Fill the length into extended_payload_length in the network byte order.
+    header[length++] = kEightBytePayloadLengthField;
+    uint64_t remaining = data_length;
+    // Fill the length into the header in the network byte order.
     for (int i = 0; i < 8; ++i) {
-      extended_payload_length[7 - i] = remaining & 0xFF;
+      header[length + 7 - i] = remaining & 0xFF;
       remaining >>= 8;
     }
-    frame.insert(frame.end(), extended_payload_length,
-                 extended_payload_length + 8);
+    length += 8;
     assert(0 == remaining);
   }
-  frame.insert(frame.end(), message, message + data_length);
-  return frame;
+  assert(length <= MAX_FRAME_HEADER_LENGTH);
+  return length;
+}
+
+// A single uv_write of an optional frame header followed by a payload. The
+// payload is owned by the request, so callers that can give up their string
+// hand it over by move and nothing is copied; the header is built inline.
+// Bytes borrowed from a longer lived string may follow the owned ones.
+struct WriteRequest {
+  WriteRequest(InspectorSocket* inspector, const char* data, size_t size)
+      : inspector(inspector)
+      , header_length(0)
+      , payload(data, size)
+      , borrowed(nullptr)
+      , borrowed_length(0) {}
+
+  WriteRequest(InspectorSocket* inspector, std::string&& data)
+      : inspector(inspector)
+      , header_length(0)
+      , payload(std::move(data))
+      , borrowed(nullptr)
+      , borrowed_length(0) {}
+
+  // Writes a slice of a string that outlives the request.
+  WriteRequest(InspectorSocket* inspector, const std::string& owner,
+               size_t offset, size_t length)
+      : inspector(inspector)
+      , header_length(0)
+      , borrowed(owner.data() + offset)
+      , borrowed_length(length) {}
+
+  // Writes data followed by body, which the request keeps alive.
+  WriteRequest(InspectorSocket* inspector, std::string&& data,
+               std::shared_ptr<const std::string> body)
+      : inspector(inspector)
+      , header_length(0)
+      , payload(std::move(data))
+      , borrowed(body->data())
+      , borrowed_length(body->size())
+      , shared_body(std::move(body)) {}
+
+  static WriteRequest* from_write_req(uv_write_t* req) {
+    return ContainerOf(&WriteRequest::req, req);
+  }
+
+  int Write(uv_write_cb write_cb);
+
+  InspectorSocket* const inspector;
+  char header[MAX_FRAME_HEADER_LENGTH];
+  size_t header_length;
+  std::string payload;
+  const char* borrowed;
+  size_t borrowed_length;
+  std::shared_ptr<const std::string> shared_body;
+  uv_write_t req;
+};
+
+static void count_write(InspectorSocket* inspector, size_t frames,
+                        size_t bytes) {
+  if (inspector->stats != nullptr) {
+    StatsAdd(&inspector->stats->socket_writes, 1);
+    StatsAdd(&inspector->stats->socket_write_frames, frames);
+    StatsAdd(&inspector->stats->socket_write_bytes, bytes);
+  }
+}
+
+int WriteRequest::Write(uv_write_cb write_cb) {
+  // libuv copies the buffer descriptors, only the bytes must stay alive.
+  uv_buf_t bufs[3];
+  unsigned int nbufs = 0;
+  if (header_length > 0)
+    bufs[nbufs++] = uv_buf_init(header, header_length);
+  if (!payload.empty() || borrowed == nullptr)
+    bufs[nbufs++] = uv_buf_init(&payload[0], payload.size());
+  if (borrowed != nullptr)
+    bufs[nbufs++] = uv_buf_init(const_cast<char*>(borrowed), borrowed_length);
+  size_t size = payload.size() + borrowed_length;
+#if DUMP_WRITES
+  printf("%s (%ld bytes):\n", __FUNCTION__, header_length + size);
+  dump_hex(header, header_length);
+  dump_hex(payload.data(), payload.size());
+  dump_hex(borrowed, borrowed_length);
+#endif
+  count_write(inspector, 1, header_length + size);
+  uv_stream_t* stream = reinterpret_cast<uv_stream_t*>(&inspector->tcp);
+  return uv_write(&req, stream, bufs, nbufs, write_cb);
+}
+
+// Frames gathered while the socket is corked. Each frame contributes its
+// inline header and its owned payload as two buffers of one uv_write.
+struct ws_write_batch_s {
+  explicit ws_write_batch_s(InspectorSocket* inspector)
+      : inspector(inspector), bytes(0) {}
+
+  static ws_write_batch_s* from_write_req(uv_write_t* req) {
+    return ContainerOf(&ws_write_batch_s::req, req);
+  }
+
+  struct Frame {
+    char header[MAX_FRAME_HEADER_LENGTH];
+    size_t header_length;
+    std::string payload;
+  };
+
+  InspectorSocket* const inspector;
+  std::deque<Frame> frames;
+  size_t bytes;
+  uv_write_t req;
+};
+
+static void free_write_batch(ws_write_batch_s* batch) {
+  delete batch;
+}
+
+static void notify_written(InspectorSocket* inspector, int status) {
+  if (inspector->written_cb != nullptr && inspector_is_active(inspector))
+    inspector->written_cb(inspector, status);
+}
+
+static void batch_write_cleanup(uv_write_t* req, int status) {
+  ws_write_batch_s* batch = ws_write_batch_s::from_write_req(req);
+  InspectorSocket* inspector = batch->inspector;
+  delete batch;
+  notify_written(inspector, status);
+}
+
+// Writes out the frames gathered so far, the socket stays corked.
+static void flush_batch(InspectorSocket* inspector) {
+  ws_write_batch_s* batch = inspector->ws_state->batch;
+  if (batch == nullptr)
+    return;
+  inspector->ws_state->batch = nullptr;
+  std::vector<uv_buf_t> bufs;
+  bufs.reserve(batch->frames.size() * 2);
+  for (ws_write_batch_s::Frame& frame : batch->frames) {
+    bufs.push_back(uv_buf_init(frame.header, frame.header_length));
+    if (!frame.payload.empty())
+      bufs.push_back(uv_buf_init(&frame.payload[0], frame.payload.size()));
+  }
+  count_write(inspector, batch->frames.size(), batch->bytes);
+  uv_stream_t* stream = reinterpret_cast<uv_stream_t*>(&inspector->tcp);
+  // libuv copies the buffer descriptors, the batch keeps the bytes alive.
+  if (uv_write(&batch->req, stream, &bufs[0], bufs.size(),
+               batch_write_cleanup) < 0) {
+    delete batch;
+  }
+}
+
+static void add_to_batch(InspectorSocket* inspector, std::string&& payload,
+                         OpCode op_code, bool compressed) {
+  ws_state_s* ws = inspector->ws_state;
+  const InspectorOptions* options = inspector->options;
+  ws_write_batch_s* batch = ws->batch;
+  if (batch != nullptr && options != nullptr &&
+      (batch->frames.size() >= options->cork_max_frames ||
+       batch->bytes + payload.size() > options->cork_max_bytes)) {
+    flush_batch(inspector);
+    batch = nullptr;
+  }
+  if (batch == nullptr) {
+    batch = new ws_write_batch_s(inspector);
+    ws->batch = batch;
+  }
+  batch->frames.push_back(ws_write_batch_s::Frame());
+  ws_write_batch_s::Frame& frame = batch->frames.back();
+  frame.payload = std::move(payload);
+  frame.header_length = encode_frame_header_hybi17(
+      frame.payload.size(), op_code, true, compressed, frame.header);
+  batch->bytes += frame.header_length + frame.payload.size();
+}
+
+// Cleanup
+static void write_request_cleanup(uv_write_t* req, int status) {
+  delete WriteRequest::from_write_req(req);
+}
+
+static void on_frame_written(uv_write_t* req, int status) {
+  InspectorSocket* inspector = WriteRequest::from_write_req(req)->inspector;
+  write_request_cleanup(req, status);
+  notify_written(inspector, status);
+}
+
+static int write_to_client(InspectorSocket* inspector,
+                           const char* msg,
+                           size_t len,
+                           uv_write_cb write_cb = write_request_cleanup) {
+  // Freed in write_request_cleanup
+  WriteRequest* wr = new WriteRequest(inspector, msg, len);
+  return wr->Write(write_cb) < 0;
+}
+
+static int write_frame_to_client(InspectorSocket* inspector,
+                                 std::string&& payload, bool binary);
+
+static int write_next_fragment(InspectorSocket* inspector);
+
+static void on_fragment_written(uv_write_t* req, int status) {
+  InspectorSocket* inspector = WriteRequest::from_write_req(req)->inspector;
+  write_request_cleanup(req, status);
+  ws_state_s* ws = inspector->ws_state;
+  // Once closing, no more data frames go out.
+  if (status < 0 || ws == nullptr || ws->close_sent ||
+      inspector->shutting_down) {
+    return;
+  }
+  if (ws->outgoing_offset < ws->outgoing_fragments.size()) {
+    write_next_fragment(inspector);
+  } else {
+    ws->sending_fragments = false;
+    ws->outgoing_fragments.clear();
+    while (!ws->deferred_messages.empty() && !ws->sending_fragments) {
+      std::string message = std::move(ws->deferred_messages.front().first);
+      bool binary = ws->deferred_messages.front().second;
+      ws->deferred_messages.pop_front();
+      ws->deferred_bytes -= message.size();
+      write_frame_to_client(inspector, std::move(message), binary);
+    }
+  }
+  notify_written(inspector, status);
+}
+
+static int write_next_fragment(InspectorSocket* inspector) {
+  ws_state_s* ws = inspector->ws_state;
+  size_t offset = ws->outgoing_offset;
+  size_t remaining = ws->outgoing_fragments.size() - offset;
+  size_t length = std::min(remaining, inspector->options->fragment_size);
+  bool first = offset == 0;
+  // Freed in write_request_cleanup, called from on_fragment_written
+  WriteRequest* wr =
+      new WriteRequest(inspector, ws->outgoing_fragments, offset, length);
+  wr->header_length = encode_frame_header_hybi17(
+      length, !first ? kOpCodeContinuation :
+          ws->outgoing_binary ? kOpCodeBinary : kOpCodeText,
+      length == remaining, first && ws->outgoing_compressed, wr->header);
+  ws->outgoing_offset += length;
+  return wr->Write(on_fragment_written) < 0;
 }
 
-static ws_decode_result decode_frame_hybi17(const std::vector<char>& buffer,
+static int write_frame_to_client(InspectorSocket* inspector,
+                                 std::string&& payload, bool binary) {
+  ws_state_s* ws = inspector->ws_state;
+  if (ws->sending_fragments) {
+    ws->deferred_bytes += payload.size();
+    ws->deferred_messages.emplace_back(std::move(payload), binary);
+    return 0;
+  }
+  OpCode op_code = binary ? kOpCodeBinary : kOpCodeText;
+  bool compressed = false;
+  ws_deflate_state_s* deflate = ws->deflate;
+  if (deflate != nullptr &&
+      payload.size() >= inspector->options->deflate_threshold) {
+    std::string output;
+    compressed = deflate_message(inspector, payload, &output);
+    if (!compressed) {
+      // The stream state is unknown now, fail the connection.
+      close_connection(inspector);
+      return 1;
+    }
+    payload.swap(output);
+  }
+  size_t fragment_size =
+      inspector->options != nullptr ? inspector->options->fragment_size : 0;
+  if (fragment_size > 0 && payload.size() > fragment_size) {
+    // Frames gathered earlier must go out first.
+    flush_batch(inspector);
+    ws->sending_fragments = true;
+    ws->outgoing_compressed = compressed;
+    ws->outgoing_binary = binary;
+    ws->outgoing_offset = 0;
+    ws->outgoing_fragments.swap(payload);
+    return write_next_fragment(inspector);
+  }
+  if (ws->corked) {
+    add_to_batch(inspector, std::move(payload), op_code, compressed);
+    return 0;
+  }
+  // Freed in write_request_cleanup, called from on_frame_written
+  WriteRequest* wr = new WriteRequest(inspector, std::move(payload));
+  wr->header_length = encode_frame_header_hybi17(
+      wr->payload.size(), op_code, true, compressed, wr->header);
+  return wr->Write(on_frame_written) < 0;
+}
+
+// Unmasks the payload in place. The key applies from the first payload byte,
+// so byte i is XORed with masking_key[i % 4]. Vector kernels run over aligned
+// blocks once a scalar prologue reaches the alignment boundary; the key is
+// rotated by the prologue length so every lane lines up with its offset.
+void inspector_unmask_payload(char* payload, size_t length,
+                              const char* masking_key) {
+  size_t i = 0;
+#if WS_UNMASK_VECTOR_WIDTH
+  const size_t kWidth = WS_UNMASK_VECTOR_WIDTH;
+  while (i < length &&
+         (reinterpret_cast<uintptr_t>(payload + i) & (kWidth - 1)) != 0) {
+    payload[i] ^= masking_key[i % kMaskingKeyWidthInBytes];
+    i++;
+  }
+  if (length - i >= kWidth) {
+    int32_t rotated_key;
+    char rotated[kMaskingKeyWidthInBytes];
+    for (size_t j = 0; j < kMaskingKeyWidthInBytes; j++)
+      rotated[j] = masking_key[(i + j) % kMaskingKeyWidthInBytes];
+    memcpy(&rotated_key, rotated, sizeof(rotated_key));
+#if WS_UNMASK_VECTOR_WIDTH == 32
+    const __m256i key = _mm256_set1_epi32(rotated_key);
+    for (; length - i >= kWidth; i += kWidth) {
+      __m256i* block = reinterpret_cast<__m256i*>(payload + i);
+      _mm256_store_si256(block, _mm256_xor_si256(_mm256_load_si256(block),
+                                                 key));
+    }
+#else
+    const __m128i key = _mm_set1_epi32(rotated_key);
+    for (; length - i >= kWidth; i += kWidth) {
+      __m128i* block = reinterpret_cast<__m128i*>(payload + i);
+      _mm_store_si128(block, _mm_xor_si128(_mm_load_si128(block), key));
+    }
+#endif
+  }
+#else
+  // Portable fallback: eight bytes at a time through a doubled key.
+  uint64_t wide_key;
+  char doubled[2 * kMaskingKeyWidthInBytes];
+  for (size_t j = 0; j < sizeof(doubled); j++)
+    doubled[j] = masking_key[j % kMaskingKeyWidthInBytes];
+  memcpy(&wide_key, doubled, sizeof(wide_key));
+  for (; length - i >= sizeof(wide_key); i += sizeof(wide_key)) {
+    uint64_t block;
+    memcpy(&block, payload + i, sizeof(block));
+    block ^= wide_key;
+    memcpy(payload + i, &block, sizeof(block));
+  }
+#endif
+  for (; i < length; ++i)
+    payload[i] ^= masking_key[i % kMaskingKeyWidthInBytes];
+}
+
+// Parses one frame at the start of [buffer, buffer + size). On FRAME_OK or
+// FRAME_CLOSE the payload has been unmasked in place and *payload points into
+// the buffer - it stays valid until the frame is consumed. Frames announcing
+// more than max_message_length bytes are rejected before they are buffered.
+static ws_decode_result decode_frame_hybi17(char* buffer,
+                                            size_t size,
                                             bool client_frame,
+                                            size_t max_message_length,
                                             int* bytes_consumed,
-                                            std::vector<char>* output,
+                                            char** payload,
+                                            size_t* payload_length,
+                                            OpCode* op_code,
+                                            bool* final,
                                             bool* compressed) {
   *bytes_consumed = 0;
-  if (buffer.size() < 2)
+  if (size < 2)
     return FRAME_INCOMPLETE;
 
-  auto it = buffer.begin();
+  char* const end = buffer + size;
+  char* it = buffer;
 
   unsigned char first_byte = *it++;
   unsigned char second_byte = *it++;
 
-  bool final = (first_byte & kFinalBit) != 0;
+  *final = (first_byte & kFinalBit) != 0;
   bool reserved1 = (first_byte & kReserved1Bit) != 0;
   bool reserved2 = (first_byte & kReserved2Bit) != 0;
   bool reserved3 = (first_byte & kReserved3Bit) != 0;
-  int op_code = first_byte & kOpCodeMask;
+  *op_code = first_byte & kOpCodeMask;
   bool masked = (second_byte & kMaskBit) != 0;
   *compressed = reserved1;
-  if (!final || reserved2 || reserved3)
+  if (reserved2 || reserved3)
     return FRAME_ERROR;  // Only compression extension is supported.
 
   bool closed = false;
-  switch (op_code) {
+  switch (*op_code) {
     case kOpCodeClose:
       closed = true;
+      // Control frames must not be fragmented.
+      if (!*final)
+        return FRAME_ERROR;
+      break;
+    case kOpCodePing:
+    case kOpCodePong:
+      if (!*final)
+        return FRAME_ERROR;
       break;
     case kOpCodeText:
+    case kOpCodeBinary:
+    case kOpCodeContinuation:
       break;
-    case kOpCodeBinary:        // We don't support binary frames yet.
-    case kOpCodeContinuation:  // We don't support binary frames yet.
-    case kOpCodePing:          // We don't support binary frames yet.
-    case kOpCodePong:          // We don't support binary frames yet.
     default:
       return FRAME_ERROR;
   }
@@ -238,7 +906,7 @@ static ws_decode_result decode_frame_hybi17(const std::vector<char>& buffer,
     } else {
       return FRAME_ERROR;
     }
-    if ((buffer.end() - it) < extended_payload_length_size)
+    if ((end - it) < extended_payload_length_size)
       return FRAME_INCOMPLETE;
     payload_length64 = 0;
     for (int i = 0; i < extended_payload_length_size; ++i) {
@@ -254,27 +922,35 @@ static ws_decode_result decode_frame_hybi17(const std::vector<char>& buffer,
     // WebSocket frame length too large.
     return FRAME_ERROR;
   }
-  size_t payload_length = static_cast<size_t>(payload_length64);
+  size_t payload_len = static_cast<size_t>(payload_length64);
+  if (payload_len > max_message_length)
+    return FRAME_ERROR;
+  if ((*op_code == kOpCodePing || *op_code == kOpCodePong) &&
+      payload_len > kMaxSingleBytePayloadLength)
+    return FRAME_ERROR;
 
-  if (buffer.size() - kMaskingKeyWidthInBytes < payload_length)
+  size_t remaining = end - it;
+  if (remaining < kMaskingKeyWidthInBytes ||
+      remaining - kMaskingKeyWidthInBytes < payload_len)
     return FRAME_INCOMPLETE;
 
-  std::vector<char>::const_iterator masking_key = it;
-  std::vector<char>::const_iterator payload = it + kMaskingKeyWidthInBytes;
-  for (size_t i = 0; i < payload_length; ++i)  // Unmask the payload.
-    output->insert(output->end(),
-                   payload[i] ^ masking_key[i % kMaskingKeyWidthInBytes]);
+  char masking_key[kMaskingKeyWidthInBytes];
+  std::copy(it, it + kMaskingKeyWidthInBytes, masking_key);
+  char* payload_start = it + kMaskingKeyWidthInBytes;
+  inspector_unmask_payload(payload_start, payload_len, masking_key);
 
-  size_t pos = it + kMaskingKeyWidthInBytes + payload_length - buffer.begin();
-  *bytes_consumed = pos;
+  *payload = payload_start;
+  *payload_length = payload_len;
+  *bytes_consumed = payload_start + payload_len - buffer;
   return closed ? FRAME_CLOSE : FRAME_OK;
 }
 
-static void invoke_read_callback(InspectorSocket* inspector,
-                                 int status, const uv_buf_t* buf) {
-  if (inspector->ws_state->read_cb) {
-    inspector->ws_state->read_cb(
-        reinterpret_cast<uv_stream_t*>(&inspector->tcp), status, buf);
+static void invoke_message_callback(InspectorSocket* inspector, int status,
+                                    const char* data, size_t len,
+                                    inspector_message_type type =
+                                        kInspectorMessageText) {
+  if (inspector->ws_state->message_cb) {
+    inspector->ws_state->message_cb(inspector, status, data, len, type);
   }
 }
 
@@ -295,7 +971,8 @@ static void on_close_frame_written(uv_write_t* req, int status) {
 static void close_frame_received(InspectorSocket* inspector) {
   inspector->ws_state->received_close = true;
   if (!inspector->ws_state->close_sent) {
-    invoke_read_callback(inspector, 0, 0);
+    invoke_message_callback(inspector, UV_EOF, nullptr, 0);
+    flush_batch(inspector);
     write_to_client(inspector, CLOSE_FRAME, sizeof(CLOSE_FRAME),
                     on_close_frame_written);
   } else {
@@ -303,48 +980,152 @@ static void close_frame_received(InspectorSocket* inspector) {
   }
 }
 
+static void write_control_frame(InspectorSocket* inspector, OpCode op_code,
+                                const char* payload, size_t len) {
+  if (inspector->ws_state->close_sent || !inspector_is_active(inspector))
+    return;
+  // Freed in write_request_cleanup
+  WriteRequest* wr = new WriteRequest(inspector, payload, len);
+  wr->header_length =
+      encode_frame_header_hybi17(len, op_code, true, false, wr->header);
+  wr->Write(write_request_cleanup);
+}
+
+// Server pings carry the send time, the pong echoes it back.
+static void pong_received(InspectorSocket* inspector, const char* payload,
+                          size_t len) {
+  uint64_t sent;
+  if (len != sizeof(sent))
+    return;  // Unsolicited pong
+  memcpy(&sent, payload, sizeof(sent));
+  uint64_t now = uv_hrtime();
+  if (sent > now)
+    return;
+  uint64_t rtt = now - sent;
+  ws_state_s* ws = inspector->ws_state;
+  // Smoothed like TCP's SRTT, 1/8 weight for the new sample.
+  ws->rtt_ns = ws->rtt_ns == 0 ? rtt : ws->rtt_ns - ws->rtt_ns / 8 + rtt / 8;
+  if (inspector->stats != nullptr)
+    StatsAdd(&inspector->stats->pongs_received, 1);
+}
+
+static size_t max_message_size(const InspectorSocket* inspector) {
+  return inspector->options != nullptr ? inspector->options->max_message_size
+                                       : SIZE_MAX;
+}
+
 static int parse_ws_frames(InspectorSocket* inspector) {
   int bytes_consumed = 0;
-  std::vector<char> output;
+  char* payload = nullptr;
+  size_t len = 0;
+  OpCode op_code = kOpCodeText;
+  bool final = true;
   bool compressed = false;
+  bool binary = false;
+  ws_state_s* ws = inspector->ws_state;
 
-  ws_decode_result r =  decode_frame_hybi17(inspector->buffer,
+  ws_decode_result r =  decode_frame_hybi17(inspector->buffer.data(),
+                                            inspector->buffer.size(),
                                             true /* client_frame */,
-                                            &bytes_consumed, &output,
+                                            max_message_size(inspector),
+                                            &bytes_consumed, &payload,
+                                            &len, &op_code, &final,
                                             &compressed);
-  // Compressed frame means client is ignoring the headers and misbehaves
-  if (compressed || r == FRAME_ERROR) {
-    invoke_read_callback(inspector, UV_EPROTO, nullptr);
+  // Compressed frame without negotiated permessage-deflate means client is
+  // ignoring the headers and misbehaves. Control frames and continuation
+  // frames never carry RSV1, the first fragment speaks for the message.
+  bool control_frame = r == FRAME_CLOSE || op_code == kOpCodePing ||
+      op_code == kOpCodePong;
+  bool protocol_error = r == FRAME_ERROR ||
+      (compressed && (ws->deflate == nullptr || control_frame ||
+                      op_code == kOpCodeContinuation));
+  bool message_complete = false;
+  if (!protocol_error && r == FRAME_OK) {
+    // Control frames may arrive between the fragments of a message.
+    if (op_code == kOpCodePing) {
+      write_control_frame(inspector, kOpCodePong, payload, len);
+    } else if (op_code == kOpCodePong) {
+      pong_received(inspector, payload, len);
+    } else if (op_code == kOpCodeContinuation) {
+      // Continuation without a first fragment, or a message too large.
+      protocol_error = !ws->receiving_fragments ||
+          len > max_message_size(inspector) - ws->incoming_fragments.size();
+      if (!protocol_error)
+        ws->incoming_fragments.append(payload, len);
+      if (!protocol_error && final) {
+        ws->receiving_fragments = false;
+        compressed = ws->incoming_compressed;
+        binary = ws->incoming_binary;
+        message_complete = true;
+      }
+    } else if (ws->receiving_fragments) {
+      // A new data message may not start before the last one finished.
+      protocol_error = true;
+    } else if (!final) {
+      ws->receiving_fragments = true;
+      ws->incoming_compressed = compressed;
+      ws->incoming_binary = op_code == kOpCodeBinary;
+      ws->incoming_fragments.assign(payload, len);
+    } else {
+      binary = op_code == kOpCodeBinary;
+      message_complete = true;
+    }
+  }
+  std::string message;
+  if (message_complete && op_code == kOpCodeContinuation) {
+    message.swap(ws->incoming_fragments);
+    payload = &message[0];
+    len = message.size();
+  }
+  if (message_complete && compressed) {
+    std::string inflated;
+    protocol_error = !inflate_message(inspector, payload, len, &inflated);
+    message.swap(inflated);
+    payload = &message[0];
+    len = message.size();
+  }
+  inspector_message_type type = kInspectorMessageBinary;
+  if (message_complete && !protocol_error && !binary) {
+    // RFC 6455 fails the connection on text that is not UTF-8. The ASCII
+    // bit found on the way spares the session another scan.
+    Utf8Kind kind = ClassifyUtf8(payload, len);
+    protocol_error = kind == Utf8Kind::kInvalid;
+    type = kind == Utf8Kind::kAscii ? kInspectorMessageAscii
+                                    : kInspectorMessageText;
+    if (inspector->stats != nullptr) {
+      StatsAdd(&inspector->stats->text_messages_in, 1);
+      if (kind == Utf8Kind::kAscii)
+        StatsAdd(&inspector->stats->text_ascii_messages_in, 1);
+      else if (kind == Utf8Kind::kInvalid)
+        StatsAdd(&inspector->stats->text_invalid_messages_in, 1);
+    }
+  }
+  if (protocol_error) {
+    invoke_message_callback(inspector, UV_EPROTO, nullptr, 0);
     close_connection(inspector);
     bytes_consumed = 0;
   } else if (r == FRAME_CLOSE) {
     close_frame_received(inspector);
     bytes_consumed = 0;
-  } else if (r == FRAME_OK && inspector->ws_state->alloc_cb
-             && inspector->ws_state->read_cb) {
-    uv_buf_t buffer;
-    size_t len = output.size();
-    inspector->ws_state->alloc_cb(
-        reinterpret_cast<uv_handle_t*>(&inspector->tcp),
-        len, &buffer);
-    assert(buffer.len >= len);
-    memcpy(buffer.base, &output[0], len);
-    invoke_read_callback(inspector, len, &buffer);
+  } else if (message_complete) {
+    // The payload is still in the receive buffer (or in message), the
+    // session copies it once into its own representation.
+    invoke_message_callback(inspector, 0, payload, len, type);
   }
   return bytes_consumed;
 }
 
 static void prepare_buffer(uv_handle_t* stream, size_t len, uv_buf_t* buf) {
-  *buf = uv_buf_init(new char[len], len);
+  InspectorSocket* inspector = inspector_from_stream(stream);
+  *buf = inspector->buffer.PrepareRead(len, inspector->read_pool);
 }
 
 static void reclaim_uv_buf(InspectorSocket* inspector, const uv_buf_t* buf,
                            ssize_t read) {
+  // The read landed in the receive buffer, only its end moves.
   if (read > 0) {
-    std::vector<char>& buffer = inspector->buffer;
-    buffer.insert(buffer.end(), buf->base, buf->base + read);
+    inspector->buffer.CommitRead(read);
   }
-  delete[] buf->base;
 }
 
 static void websockets_data_cb(uv_stream_t* stream, ssize_t nread,
@@ -353,8 +1134,8 @@ static void websockets_data_cb(uv_stream_t* stream, ssize_t nread,
   reclaim_uv_buf(inspector, buf, nread);
   if (nread < 0 || nread == UV_EOF) {
     inspector->connection_eof = true;
-    if (!inspector->shutting_down && inspector->ws_state->read_cb) {
-      inspector->ws_state->read_cb(stream, nread, nullptr);
+    if (!inspector->shutting_down) {
+      invoke_message_callback(inspector, nread, nullptr, 0);
     }
     if (inspector->ws_state->close_sent &&
         !inspector->ws_state->received_close) {
@@ -374,19 +1155,19 @@ static void websockets_data_cb(uv_stream_t* stream, ssize_t nread,
       processed = parse_ws_frames(inspector);
       // 3. Fix the buffer size & length
       if (processed > 0) {
-        remove_from_beginning(&inspector->buffer, processed);
+        inspector->buffer.Consume(processed);
       }
     } while (processed > 0 && !inspector->buffer.empty());
+    inspector->buffer.ReleaseIfEmpty();
   }
 }
 
 int inspector_read_start(InspectorSocket* inspector,
-                         uv_alloc_cb alloc_cb, uv_read_cb read_cb) {
+                         ws_message_cb callback) {
   assert(inspector->ws_mode);
-  assert(!inspector->shutting_down || read_cb == nullptr);
+  assert(!inspector->shutting_down || callback == nullptr);
   inspector->ws_state->close_sent = false;
-  inspector->ws_state->alloc_cb = alloc_cb;
-  inspector->ws_state->read_cb = read_cb;
+  inspector->ws_state->message_cb = callback;
   int err =
       uv_read_start(reinterpret_cast<uv_stream_t*>(&inspector->tcp),
                     prepare_buffer,
@@ -399,8 +1180,7 @@ int inspector_read_start(InspectorSocket* inspector,
 
 void inspector_read_stop(InspectorSocket* inspector) {
   uv_read_stop(reinterpret_cast<uv_stream_t*>(&inspector->tcp));
-  inspector->ws_state->alloc_cb = nullptr;
-  inspector->ws_state->read_cb = nullptr;
+  inspector->ws_state->message_cb = nullptr;
 }
 
 static void generate_accept_string(const std::string& client_key,
@@ -414,16 +1194,50 @@ static void generate_accept_string(const std::string& client_key,
   base64_encode(hash, sizeof(hash), *buffer, sizeof(*buffer));
 }
 
+template <size_t N>
+static bool header_name_is(const char* name, size_t length,
+                           const char (&expected)[N]) {
+  return length == N - 1 && StringEqualNoCaseN(name, expected, N - 1);
+}
+
 static int header_value_cb(http_parser* parser, const char* at, size_t length) {
   static const char SEC_WEBSOCKET_KEY_HEADER[] = "Sec-WebSocket-Key";
+  static const char SEC_WEBSOCKET_EXTENSIONS_HEADER[] =
+      "Sec-WebSocket-Extensions";
+  static const char IF_NONE_MATCH_HEADER[] = "If-None-Match";
+  static const char ACCEPT_ENCODING_HEADER[] = "Accept-Encoding";
   auto inspector = static_cast<InspectorSocket*>(parser->data);
   auto state = inspector->http_parsing_state;
+  bool value_start = !state->parsing_value;
   state->parsing_value = true;
   if (state->current_header.size() == sizeof(SEC_WEBSOCKET_KEY_HEADER) - 1 &&
       StringEqualNoCaseN(state->current_header.data(),
                                SEC_WEBSOCKET_KEY_HEADER,
                                sizeof(SEC_WEBSOCKET_KEY_HEADER) - 1)) {
     state->ws_key.append(at, length);
+  } else if (state->current_header.size() ==
+                 sizeof(SEC_WEBSOCKET_EXTENSIONS_HEADER) - 1 &&
+             StringEqualNoCaseN(state->current_header.data(),
+                                SEC_WEBSOCKET_EXTENSIONS_HEADER,
+                                sizeof(SEC_WEBSOCKET_EXTENSIONS_HEADER) - 1)) {
+    // Repeated extension headers are equivalent to one comma-joined list.
+    if (value_start && !state->ws_extensions.empty())
+      state->ws_extensions.append(", ");
+    state->ws_extensions.append(at, length);
+  } else if (header_name_is(state->current_header.data(),
+                            state->current_header.size(),
+                            IF_NONE_MATCH_HEADER)) {
+    std::string* value = &state->request.if_none_match;
+    if (value_start && !value->empty())
+      value->append(", ");
+    value->append(at, length);
+  } else if (header_name_is(state->current_header.data(),
+                            state->current_header.size(),
+                            ACCEPT_ENCODING_HEADER)) {
+    std::string* value = &state->request.accept_encoding;
+    if (value_start && !value->empty())
+      value->append(", ");
+    value->append(at, length);
   }
   return 0;
 }
@@ -446,10 +1260,12 @@ static int path_cb(http_parser* parser, const char* at, size_t length) {
   return 0;
 }
 
-static void handshake_complete(InspectorSocket* inspector) {
+static void handshake_complete(InspectorSocket* inspector,
+                               ws_deflate_state_s* deflate) {
   uv_read_stop(reinterpret_cast<uv_stream_t*>(&inspector->tcp));
   handshake_cb callback = inspector->http_parsing_state->callback;
   inspector->ws_state = new ws_state_s();
+  inspector->ws_state->deflate = deflate;
   inspector->ws_mode = true;
   callback(inspector, kInspectorHandshakeUpgraded,
            inspector->http_parsing_state->path);
@@ -494,17 +1310,38 @@ static void handshake_failed(InspectorSocket* inspector) {
                   then_close_and_report_failure);
 }
 
-// init_handshake references message_complete_cb
+// init_handshake references request_complete
 static void init_handshake(InspectorSocket* socket);
 
-static int message_complete_cb(http_parser* parser) {
-  InspectorSocket* inspector = static_cast<InspectorSocket*>(parser->data);
+static void response_shutdown_cb(uv_shutdown_t* req, int status) {
+  InspectorSocket* inspector = inspector_from_stream(req->handle);
+  delete req;
+  close_and_report_handshake_failure(inspector);
+}
+
+// Closes the connection once the response written so far went out, for
+// requests that did not ask to keep it alive.
+static void close_after_response(InspectorSocket* inspector) {
+  uv_stream_t* stream = reinterpret_cast<uv_stream_t*>(&inspector->tcp);
+  uv_read_stop(stream);
+  uv_shutdown_t* req = new uv_shutdown_t;
+  if (uv_shutdown(req, stream, response_shutdown_cb) != 0) {
+    delete req;
+    close_and_report_handshake_failure(inspector);
+  }
+}
+
+static void request_complete(InspectorSocket* inspector, bool is_get,
+                             bool upgrade) {
   struct http_parsing_state_s* state = inspector->http_parsing_state;
-  if (parser->method != HTTP_GET) {
+  if (!is_get) {
     handshake_failed(inspector);
-  } else if (!parser->upgrade) {
+  } else if (!upgrade) {
     if (state->callback(inspector, kInspectorHandshakeHttpGet, state->path)) {
-      init_handshake(inspector);
+      if (state->request.keep_alive)
+        init_handshake(inspector);
+      else
+        close_after_response(inspector);
     } else {
       handshake_failed(inspector);
     }
@@ -521,9 +1358,22 @@ static int message_complete_cb(http_parser* parser) {
     const char accept_ws_suffix[] = "\r\n\r\n";
     std::string reply(accept_ws_prefix, sizeof(accept_ws_prefix) - 1);
     reply.append(accept_string, sizeof(accept_string));
+    ws_deflate_state_s* deflate = nullptr;
+    ws_deflate_params deflate_params;
+    std::string deflate_response;
+    const InspectorOptions* options = inspector->options;
+    if (options != nullptr && options->deflate_enabled &&
+        negotiate_permessage_deflate(state->ws_extensions, *options,
+                                     &deflate_params, &deflate_response)) {
+      deflate = create_deflate_state(deflate_params, options->deflate_level);
+    }
+    if (deflate != nullptr) {
+      reply.append("\r\nSec-WebSocket-Extensions: ");
+      reply.append(deflate_response);
+    }
     reply.append(accept_ws_suffix, sizeof(accept_ws_suffix) - 1);
     if (write_to_client(inspector, &reply[0], reply.size()) >= 0) {
-      handshake_complete(inspector);
+      handshake_complete(inspector, deflate);
       inspector->http_parsing_state->done = true;
     } else {
       close_and_report_handshake_failure(inspector);
@@ -531,9 +1381,185 @@ static int message_complete_cb(http_parser* parser) {
   } else {
     handshake_failed(inspector);
   }
+}
+
+static int message_complete_cb(http_parser* parser) {
+  InspectorSocket* inspector = static_cast<InspectorSocket*>(parser->data);
+  bool keep_alive = http_should_keep_alive(parser) != 0;
+  inspector->http_parsing_state->request.keep_alive = keep_alive;
+  request_complete(inspector, parser->method == HTTP_GET, parser->upgrade);
+  // Nothing after the last request on the connection gets parsed.
+  if (!keep_alive)
+    http_parser_pause(parser, 1);
   return 0;
 }
 
+// Same test http_parser applies to the Connection header, for token being
+// "upgrade", "close" or "keep-alive".
+template <size_t N>
+static bool connection_has_token(const char* value, size_t length,
+                                 const char (&token)[N]) {
+  const char* end = value + length;
+  while (value < end) {
+    const char* comma = static_cast<const char*>(
+        memchr(value, ',', end - value));
+    const char* token_end = comma != nullptr ? comma : end;
+    while (value < token_end && (*value == ' ' || *value == '\t'))
+      value++;
+    const char* trimmed_end = token_end;
+    while (trimmed_end > value &&
+           (trimmed_end[-1] == ' ' || trimmed_end[-1] == '\t'))
+      trimmed_end--;
+    if (header_name_is(value, trimmed_end - value, token))
+      return true;
+    value = comma != nullptr ? comma + 1 : end;
+  }
+  return false;
+}
+
+// Handles the common case of a whole GET request head arriving in a single
+// read without running http_parser and its per-header callbacks. Only the
+// request line, Upgrade, Connection, Sec-WebSocket-Key,
+// Sec-WebSocket-Extensions, If-None-Match and Accept-Encoding are looked
+// at. Returns false without touching the parsing state for anything else -
+// other methods, partial or pipelined requests, bodies, folded or malformed
+// headers - which then goes through http_parser as before.
+static bool parse_request_fast(const char* data, size_t len,
+                               http_parsing_state_s* state, bool* upgrade) {
+  static const char METHOD[] = "GET ";
+  static const char VERSION[] = " HTTP/1.";
+  static const char UPGRADE_HEADER[] = "Upgrade";
+  static const char CONNECTION_HEADER[] = "Connection";
+  static const char CONTENT_LENGTH_HEADER[] = "Content-Length";
+  static const char TRANSFER_ENCODING_HEADER[] = "Transfer-Encoding";
+  static const char SEC_WEBSOCKET_KEY_HEADER[] = "Sec-WebSocket-Key";
+  static const char SEC_WEBSOCKET_EXTENSIONS_HEADER[] =
+      "Sec-WebSocket-Extensions";
+  static const char IF_NONE_MATCH_HEADER[] = "If-None-Match";
+  static const char ACCEPT_ENCODING_HEADER[] = "Accept-Encoding";
+  static const char UPGRADE_TOKEN[] = "upgrade";
+  static const char CLOSE_TOKEN[] = "close";
+  static const char KEEP_ALIVE_TOKEN[] = "keep-alive";
+  const char* end = data + len;
+  if (len > HTTP_MAX_HEADER_SIZE || len < sizeof(METHOD) - 1 ||
+      memcmp(data, METHOD, sizeof(METHOD) - 1) != 0) {
+    return false;
+  }
+  const char* path = data + sizeof(METHOD) - 1;
+  const char* p = path;
+  while (p < end && *p > ' ' && *p < '\x7f')
+    p++;
+  if (p == path || *path != '/' ||
+      static_cast<size_t>(end - p) < sizeof(VERSION) + 2 ||
+      memcmp(p, VERSION, sizeof(VERSION) - 1) != 0) {
+    return false;
+  }
+  const char* path_end = p;
+  p += sizeof(VERSION) - 1;
+  if ((*p != '0' && *p != '1') || p[1] != '\r' || p[2] != '\n')
+    return false;
+  bool http_1_1 = *p == '1';
+  p += 3;
+
+  const char* key = nullptr;
+  size_t key_length = 0;
+  const char* extensions = nullptr;
+  size_t extensions_length = 0;
+  std::string joined_extensions;
+  const char* if_none_match = nullptr;
+  size_t if_none_match_length = 0;
+  const char* accept_encoding = nullptr;
+  size_t accept_encoding_length = 0;
+  bool upgrade_header = false;
+  bool connection_upgrade = false;
+  bool connection_close = false;
+  bool connection_keep_alive = false;
+  for (;;) {
+    if (end - p < 2)
+      return false;
+    if (p[0] == '\r' && p[1] == '\n') {
+      p += 2;
+      break;
+    }
+    const char* name = p;
+    p = http_scan_token(p, end);
+    if (p == name || p == end || *p != ':')
+      return false;
+    size_t name_length = p - name;
+    p++;
+    while (p < end && (*p == ' ' || *p == '\t'))
+      p++;
+    const char* value = p;
+    p = http_scan_header_value(p, end);
+    if (end - p < 2 || p[0] != '\r' || p[1] != '\n')
+      return false;
+    size_t value_length = p - value;
+    p += 2;
+    if (p < end && (*p == ' ' || *p == '\t'))
+      return false;  // Obsolete line folding
+    if (header_name_is(name, name_length, SEC_WEBSOCKET_KEY_HEADER)) {
+      if (key != nullptr)
+        return false;
+      key = value;
+      key_length = value_length;
+    } else if (header_name_is(name, name_length,
+                              SEC_WEBSOCKET_EXTENSIONS_HEADER)) {
+      // Repeated extension headers are equivalent to one comma-joined list.
+      if (extensions != nullptr) {
+        if (joined_extensions.empty())
+          joined_extensions.assign(extensions, extensions_length);
+        joined_extensions.append(", ");
+        joined_extensions.append(value, value_length);
+      }
+      extensions = value;
+      extensions_length = value_length;
+    } else if (header_name_is(name, name_length, UPGRADE_HEADER)) {
+      upgrade_header = true;
+    } else if (header_name_is(name, name_length, CONNECTION_HEADER)) {
+      connection_upgrade = connection_upgrade ||
+          connection_has_token(value, value_length, UPGRADE_TOKEN);
+      connection_close = connection_close ||
+          connection_has_token(value, value_length, CLOSE_TOKEN);
+      connection_keep_alive = connection_keep_alive ||
+          connection_has_token(value, value_length, KEEP_ALIVE_TOKEN);
+    } else if (header_name_is(name, name_length, IF_NONE_MATCH_HEADER)) {
+      if (if_none_match != nullptr)
+        return false;
+      if_none_match = value;
+      if_none_match_length = value_length;
+    } else if (header_name_is(name, name_length, ACCEPT_ENCODING_HEADER)) {
+      if (accept_encoding != nullptr)
+        return false;
+      accept_encoding = value;
+      accept_encoding_length = value_length;
+    } else if (header_name_is(name, name_length, CONTENT_LENGTH_HEADER) ||
+               header_name_is(name, name_length, TRANSFER_ENCODING_HEADER)) {
+      return false;
+    }
+  }
+  if (p != end)
+    return false;
+
+  state->path.assign(path, path_end - path);
+  if (key != nullptr)
+    state->ws_key.assign(key, key_length);
+  if (!joined_extensions.empty())
+    state->ws_extensions.swap(joined_extensions);
+  else if (extensions != nullptr)
+    state->ws_extensions.assign(extensions, extensions_length);
+  if (if_none_match != nullptr)
+    state->request.if_none_match.assign(if_none_match, if_none_match_length);
+  if (accept_encoding != nullptr) {
+    state->request.accept_encoding.assign(accept_encoding,
+                                          accept_encoding_length);
+  }
+  // As http_should_keep_alive decides it.
+  state->request.keep_alive =
+      http_1_1 ? !connection_close : connection_keep_alive;
+  *upgrade = upgrade_header && connection_upgrade;
+  return true;
+}
+
 static void data_received_cb(uv_stream_s* tcp, ssize_t nread,
                              const uv_buf_t* buf) {
 #if DUMP_READS
@@ -557,11 +1583,21 @@ static void data_received_cb(uv_stream_s* tcp, ssize_t nread,
   } else {
     http_parsing_state_s* state = inspector->http_parsing_state;
     http_parser* parser = &state->parser;
-    http_parser_execute(parser, &state->parser_settings,
-                        inspector->buffer.data(), nread);
-    remove_from_beginning(&inspector->buffer, nread);
-    if (parser->http_errno != HPE_OK) {
-      handshake_failed(inspector);
+    bool upgrade;
+    if (http_parser_at_message_start(parser) &&
+        parse_request_fast(inspector->buffer.data(), nread, state, &upgrade)) {
+      request_complete(inspector, true, upgrade);
+      inspector->buffer.Consume(nread);
+      inspector->buffer.ReleaseIfEmpty();
+    } else {
+      http_parser_execute(parser, &state->parser_settings,
+                          inspector->buffer.data(), nread);
+      inspector->buffer.Consume(nread);
+      inspector->buffer.ReleaseIfEmpty();
+      // Paused after the last request the connection serves.
+      if (parser->http_errno != HPE_OK && parser->http_errno != HPE_PAUSED) {
+        handshake_failed(inspector);
+      }
     }
     if (inspector->http_parsing_state->done) {
       cleanup_http_parsing_state(inspector);
@@ -574,7 +1610,11 @@ static void init_handshake(InspectorSocket* socket) {
   assert(state != nullptr);
   state->current_header.clear();
   state->ws_key.clear();
+  state->ws_extensions.clear();
   state->path.clear();
+  state->request.keep_alive = false;
+  state->request.if_none_match.clear();
+  state->request.accept_encoding.clear();
   state->done = false;
   http_parser_init(&state->parser, HTTP_REQUEST);
   state->parser.data = socket;
@@ -593,7 +1633,11 @@ int inspector_accept(uv_stream_t* server, InspectorSocket* socket,
 
   socket->http_parsing_state = new http_parsing_state_s();
   uv_stream_t* tcp = reinterpret_cast<uv_stream_t*>(&socket->tcp);
-  int err = uv_tcp_init(server->loop, &socket->tcp);
+  int err;
+  if (server->type == UV_NAMED_PIPE)
+    err = uv_pipe_init(server->loop, &socket->pipe, 0);
+  else
+    err = uv_tcp_init(server->loop, &socket->tcp);
 
   if (err == 0) {
     err = uv_accept(server, tcp);
@@ -613,13 +1657,32 @@ int inspector_accept(uv_stream_t* server, InspectorSocket* socket,
 void inspector_write(InspectorSocket* inspector, const char* data,
                      size_t len) {
   if (inspector->ws_mode) {
-    std::vector<char> output = encode_frame_hybi17(data, len);
-    write_to_client(inspector, &output[0], output.size());
+    write_frame_to_client(inspector, std::string(data, len), false);
   } else {
     write_to_client(inspector, data, len);
   }
 }
 
+void inspector_write(InspectorSocket* inspector, std::string&& data,
+                     bool binary) {
+  if (inspector->ws_mode) {
+    write_frame_to_client(inspector, std::move(data), binary);
+  } else {
+    // Freed in write_request_cleanup
+    WriteRequest* wr = new WriteRequest(inspector, std::move(data));
+    wr->Write(write_request_cleanup);
+  }
+}
+
+void inspector_write_response(InspectorSocket* inspector, std::string&& head,
+                              std::shared_ptr<const std::string> body) {
+  assert(!inspector->ws_mode);
+  // Freed in write_request_cleanup
+  WriteRequest* wr =
+      new WriteRequest(inspector, std::move(head), std::move(body));
+  wr->Write(write_request_cleanup);
+}
+
 void inspector_close(InspectorSocket* inspector,
                      inspector_cb callback) {
   // libuv throws assertions when closing stream that's already closed - we
@@ -632,12 +1695,70 @@ void inspector_close(InspectorSocket* inspector,
     close_connection(inspector);
   } else {
     inspector_read_stop(inspector);
+    flush_batch(inspector);
     write_to_client(inspector, CLOSE_FRAME, sizeof(CLOSE_FRAME),
                     on_close_frame_written);
-    inspector_read_start(inspector, nullptr, nullptr);
+    inspector_read_start(inspector, nullptr);
   }
 }
 
+void inspector_cork(InspectorSocket* inspector) {
+  if (inspector->ws_mode && inspector_is_active(inspector))
+    inspector->ws_state->corked = true;
+}
+
+void inspector_uncork(InspectorSocket* inspector) {
+  if (!inspector->ws_mode || !inspector->ws_state->corked)
+    return;
+  inspector->ws_state->corked = false;
+  if (inspector_is_active(inspector)) {
+    flush_batch(inspector);
+  } else {
+    delete inspector->ws_state->batch;
+    inspector->ws_state->batch = nullptr;
+  }
+}
+
+void inspector_ping(InspectorSocket* inspector) {
+  if (!inspector->ws_mode)
+    return;
+  uint64_t now = uv_hrtime();
+  write_control_frame(inspector, kOpCodePing,
+                      reinterpret_cast<const char*>(&now), sizeof(now));
+  if (inspector->stats != nullptr)
+    StatsAdd(&inspector->stats->pings_sent, 1);
+}
+
+uint64_t inspector_rtt_ns(const InspectorSocket* inspector) {
+  return inspector->ws_mode ? inspector->ws_state->rtt_ns : 0;
+}
+
+size_t inspector_write_queue_size(const InspectorSocket* inspector) {
+  const uv_stream_t* stream =
+      reinterpret_cast<const uv_stream_t*>(&inspector->tcp);
+#if UV_VERSION_HEX >= 0x011300
+  size_t size = uv_stream_get_write_queue_size(stream);
+#else
+  size_t size = stream->write_queue_size;
+#endif
+  const ws_state_s* ws = inspector->ws_state;
+  if (inspector->ws_mode && ws != nullptr) {
+    if (ws->batch != nullptr)
+      size += ws->batch->bytes;
+    if (ws->sending_fragments)
+      size += ws->outgoing_fragments.size() - ws->outgoing_offset;
+    size += ws->deferred_bytes;
+  }
+  return size;
+}
+
+const inspector_http_request* inspector_get_request(
+    const InspectorSocket* inspector) {
+  if (inspector->http_parsing_state == nullptr)
+    return nullptr;
+  return &inspector->http_parsing_state->request;
+}
+
 bool inspector_is_active(const InspectorSocket* inspector) {
   const uv_handle_t* tcp =
       reinterpret_cast<const uv_handle_t*>(&inspector->tcp);
@@ -24,9 +24,14 @@
 #define SRC_INSPECTOR_SOCKET_H_
 
 #include "http_parser.h"
+#include "inspector_options.h"
+#include "inspector_stats.h"
 #include "uv.h"
 
+#include <deque>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace inspector {
@@ -38,9 +43,23 @@ enum inspector_handshake_event {
   kInspectorHandshakeFailed
 };
 
+// Text messages are validated as UTF-8 before they are handed out, those
+// that are plain ASCII are marked as such.
+enum inspector_message_type {
+  kInspectorMessageText,
+  kInspectorMessageAscii,
+  kInspectorMessageBinary
+};
+
 class InspectorSocket;
 
 typedef void (*inspector_cb)(InspectorSocket*, int);
+// Receives each complete WebSocket message as a view into the receive
+// buffer, valid for the duration of the call only. A negative status
+// (UV_EOF after a close frame or end of stream, UV_EPROTO, ...) reports the
+// end of the connection, data is nullptr then.
+typedef void (*ws_message_cb)(InspectorSocket*, int status, const char* data,
+                              size_t len, enum inspector_message_type type);
 // Notifies as handshake is progressing. Returning false as a response to
 // kInspectorHandshakeUpgrading or kInspectorHandshakeHttpGet event will abort
 // the connection. inspector_write can be used from the callback.
@@ -48,6 +67,16 @@ typedef bool (*handshake_cb)(InspectorSocket*,
                              enum inspector_handshake_event state,
                              const std::string& path);
 
+// What the server needs to know about a plain HTTP GET request beyond its
+// path, see inspector_get_request.
+struct inspector_http_request {
+  // Whether the connection may serve another request, per HTTP version and
+  // Connection header. If not, it is closed once the response is written.
+  bool keep_alive;
+  std::string if_none_match;
+  std::string accept_encoding;
+};
+
 struct http_parsing_state_s {
   http_parser parser;
   http_parser_settings parser_settings;
@@ -55,16 +84,44 @@ struct http_parsing_state_s {
   bool done;
   bool parsing_value;
   std::string ws_key;
+  std::string ws_extensions;
   std::string path;
   std::string current_header;
+  inspector_http_request request;
 };
 
+struct ws_deflate_state_s;
+struct ws_write_batch_s;
+
 struct ws_state_s {
-  uv_alloc_cb alloc_cb;
-  uv_read_cb read_cb;
+  ws_message_cb message_cb;
   inspector_cb close_cb;
   bool close_sent;
   bool received_close;
+  // Non-null if permessage-deflate was negotiated during the upgrade.
+  ws_deflate_state_s* deflate;
+  // Incoming message split into several frames, collected until the final
+  // continuation frame arrives.
+  bool receiving_fragments;
+  bool incoming_compressed;
+  bool incoming_binary;
+  std::string incoming_fragments;
+  // Outgoing message written one fragment at a time so that control frames
+  // can go out between fragments. Data messages sent meanwhile wait in
+  // deferred_messages to keep their order.
+  bool sending_fragments;
+  bool outgoing_compressed;
+  bool outgoing_binary;
+  size_t outgoing_offset;
+  std::string outgoing_fragments;
+  // Payload, and whether it goes out as a binary message.
+  std::deque<std::pair<std::string, bool>> deferred_messages;
+  size_t deferred_bytes;
+  // While corked, frames are gathered in batch and written together.
+  bool corked;
+  ws_write_batch_s* batch;
+  // Smoothed round trip of server pings, 0 until the first pong.
+  uint64_t rtt_ns;
 };
 
 inline char ToLower(char c) {
@@ -124,12 +181,79 @@ inline ContainerOfHelper<Inner, Outer> ContainerOf(Inner Outer::*field,
 }
 
 
-// HTTP Wrapper around a uv_tcp_t
+// Fixed size read blocks shared by all sockets of one loop, and only used
+// from that loop's thread.
+class ReadBufferPool {
+ public:
+  // libuv suggests 64 KB for every read.
+  static const size_t kBlockSize = 64 * 1024;
+
+  explicit ReadBufferPool(InspectorStats* stats) : stats_(stats) { }
+  ~ReadBufferPool();
+
+  char* Acquire();
+  void Release(char* block);
+
+ private:
+  ReadBufferPool(const ReadBufferPool&) = delete;
+  ReadBufferPool& operator=(const ReadBufferPool&) = delete;
+
+  // Free blocks kept for reuse, more are returned to the heap.
+  static const size_t kMaxFreeBlocks = 8;
+  std::vector<char*> free_blocks_;
+  InspectorStats* const stats_;
+};
+
+// Receive buffer with separate read and write cursors. Parsed frames are
+// consumed by advancing the read cursor; the unread tail is only moved back
+// to the front when an append would otherwise run past the end of storage.
+class ReceiveBuffer {
+ public:
+  ReceiveBuffer() : storage_(nullptr), capacity_(0), read_pos_(0),
+                    write_pos_(0), pool_(nullptr) { }
+  ~ReceiveBuffer() { clear(); }
+
+  char* data() { return storage_ + read_pos_; }
+  size_t size() const { return write_pos_ - read_pos_; }
+  bool empty() const { return read_pos_ == write_pos_; }
+
+  void Append(const char* data, size_t len);
+  // Room at the end of the buffer for a read of up to len bytes, so that
+  // reads land in place. Storage comes from pool while the buffer is empty.
+  uv_buf_t PrepareRead(size_t len, ReadBufferPool* pool);
+  void CommitRead(size_t len) { write_pos_ += len; }
+  // Advances the read cursor past bytes that were parsed.
+  void Consume(size_t count);
+  // Gives the storage back once everything was parsed, idle sockets then
+  // hold no read memory.
+  void ReleaseIfEmpty() {
+    if (empty())
+      clear();
+  }
+  void clear();
+
+ private:
+  ReceiveBuffer(const ReceiveBuffer&) = delete;
+  ReceiveBuffer& operator=(const ReceiveBuffer&) = delete;
+
+  void EnsureWritable(size_t len);
+
+  char* storage_;
+  size_t capacity_;
+  size_t read_pos_;
+  size_t write_pos_;
+  // Non-null if storage_ is a block of this pool.
+  ReadBufferPool* pool_;
+};
+
+// HTTP Wrapper around a uv_tcp_t, or a uv_pipe_t if accepted on a Unix socket
 class InspectorSocket {
  public:
   InspectorSocket() : data(nullptr), http_parsing_state(nullptr),
-                      ws_state(nullptr), buffer(0), ws_mode(false),
-                      shutting_down(false), connection_eof(false) { }
+                      ws_state(nullptr), options(nullptr), stats(nullptr),
+                      read_pool(nullptr), written_cb(nullptr),
+                      ws_mode(false), shutting_down(false),
+                      connection_eof(false) { }
   ~InspectorSocket()
   {
       magic_ = BAD_MAGIC;
@@ -140,8 +264,22 @@ class InspectorSocket {
   void* data;
   struct http_parsing_state_s* http_parsing_state;
   struct ws_state_s* ws_state;
-  std::vector<char> buffer;
-  uv_tcp_t tcp;
+  // Owned by the server. Without options no WebSocket extension is
+  // negotiated; without stats nothing is counted.
+  const InspectorOptions* options;
+  InspectorStats* stats;
+  // Owned by the server as well. Without a pool every read allocates.
+  ReadBufferPool* read_pool;
+  // Called after each WebSocket frame write completes, e.g. to watch the
+  // write queue drain.
+  inspector_cb written_cb;
+  ReceiveBuffer buffer;
+  // Both start with the uv_stream_t fields, the rest of the code only uses
+  // tcp as a stream.
+  union {
+    uv_tcp_t tcp;
+    uv_pipe_t pipe;
+  };
   bool ws_mode;
   bool shutting_down;
   bool connection_eof;
@@ -157,14 +295,36 @@ int inspector_accept(uv_stream_t* server, InspectorSocket* inspector,
 void inspector_close(InspectorSocket* inspector,
                      inspector_cb callback);
 
-// Callbacks will receive stream handles. Use inspector_from_stream to get
-// InspectorSocket* from the stream handle.
-int inspector_read_start(InspectorSocket* inspector, uv_alloc_cb,
-                          uv_read_cb);
+int inspector_read_start(InspectorSocket* inspector, ws_message_cb callback);
 void inspector_read_stop(InspectorSocket* inspector);
 void inspector_write(InspectorSocket* inspector,
     const char* data, size_t len);
+// Takes ownership of data, the payload is written without being copied.
+// In WebSocket mode, binary sends a binary instead of a text message.
+void inspector_write(InspectorSocket* inspector, std::string&& data,
+                     bool binary = false);
+// Outside of WebSocket mode: writes head and body in one uv_write. The body
+// is shared rather than copied, so cached HTTP responses are sent as they
+// are.
+void inspector_write_response(InspectorSocket* inspector, std::string&& head,
+                              std::shared_ptr<const std::string> body);
 bool inspector_is_active(const InspectorSocket* inspector);
+// The request being answered, valid during kInspectorHandshakeHttpGet.
+const inspector_http_request* inspector_get_request(
+    const InspectorSocket* inspector);
+// Frames written between cork and uncork go out in one vectored uv_write,
+// or several if InspectorOptions::cork_max_bytes/cork_max_frames are hit.
+void inspector_cork(InspectorSocket* inspector);
+void inspector_uncork(InspectorSocket* inspector);
+// Sends a ping, the pong updates the round trip estimate.
+void inspector_ping(InspectorSocket* inspector);
+uint64_t inspector_rtt_ns(const InspectorSocket* inspector);
+// Bytes given to inspector_write that the socket has not accepted yet.
+size_t inspector_write_queue_size(const InspectorSocket* inspector);
+// XORs a client frame payload with its 4 byte masking key, in place. Used by
+// the frame decoder, exposed for bench/.
+void inspector_unmask_payload(char* payload, size_t length,
+                              const char* masking_key);
 
 inline InspectorSocket* inspector_from_stream(uv_tcp_t* stream) {
   return ContainerOf(&InspectorSocket::tcp, stream);
@@ -21,7 +21,9 @@
 */
 
 #include "inspector_socket_server.h"
+#include "inspector_cbor.h"
 #include "inspector_socket.h"
+#include "inspector_utf8.h"
 
 #include "uv.h"
 #include "zlib.h"
@@ -30,9 +32,18 @@
 #include <map>
 #include <set>
 #include <sstream>
+#include <cstdlib>
 #include <cstring>
 #include <cassert>
 
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <unistd.h>
+#endif
+
 
 namespace inspector {
 
@@ -59,6 +70,15 @@ std::string FormatWsAddress(const std::string& host, int port,
   return url.str();
 }
 
+// The ws+unix://<socket path>:/<target> form understood by e.g. the ws
+// package of Node.js.
+std::string FormatWsUnixAddress(const std::string& socket_path,
+                                const std::string& target_id,
+                                bool include_protocol) {
+  std::string url = include_protocol ? "ws+unix://" : "";
+  return url + socket_path + ":/" + target_id;
+}
+
 
 std::string MakeFrontEndURL(const std::string& host,
                             int port,
@@ -73,10 +93,12 @@ std::string MakeFrontEndURL(const std::string& host,
 
 namespace {
 
+// Generated by compress_json.py: the size of the JSON (24 bits BE), its
+// CRC-32 (32 bits BE), then the JSON as a zlib stream.
 static const uint8_t PROTOCOL_JSON[] = {
-//  #include "v8_inspector_protocol_json.h"  // NOLINT(build/include_order)
-    '0'
+  #include "v8_inspector_protocol_json.h"  // NOLINT(build/include_order)
 };
+const size_t kProtocolJsonHeaderSize = 7;
 
 void Escape(std::string* string) {
   for (char& c : *string) {
@@ -99,19 +121,26 @@ std::string MapToString(const std::map<std::string, std::string>& object) {
   return json.str();
 }
 
-std::string MapsToString(
-    const std::vector<std::map<std::string, std::string>>& array) {
-  bool first = true;
-  std::ostringstream json;
-  json << "[ ";
-  for (const auto& object : array) {
-    if (!first)
-      json << ", ";
-    first = false;
-    json << MapToString(object);
+// Objects already serialized by MapToString.
+std::string JoinJsonArray(const std::vector<std::string>& objects) {
+  std::string json = "[ ";
+  for (size_t i = 0; i < objects.size(); i++) {
+    if (i > 0)
+      json += ", ";
+    json += objects[i];
   }
-  json << "]\n\n";
-  return json.str();
+  json += "]\n\n";
+  return json;
+}
+
+// Splits "target?query" and looks for a "name=value" pair in the query.
+bool SplitQueryParameter(std::string* path, const char* parameter) {
+  size_t query_start = path->find('?');
+  if (query_start == std::string::npos)
+    return false;
+  std::string query = "&" + path->substr(query_start + 1) + "&";
+  path->resize(query_start);
+  return query.find("&" + std::string(parameter) + "&") != std::string::npos;
 }
 
 const char* MatchPathSegment(const char* path, const char* expected) {
@@ -123,22 +152,26 @@ const char* MatchPathSegment(const char* path, const char* expected) {
   return nullptr;
 }
 
-void OnBufferAlloc(uv_handle_t* handle, size_t len, uv_buf_t* buf) {
-  buf->base = new char[len];
-  buf->len = len;
-}
-
+// A unix_socket_path replaces host and port, its targets are reported with
+// their WebSocket URL as DevTools cannot open it.
 std::string PrintDebuggerReadyMessage(const std::string& host,
                                int port,
+                               const std::string& unix_socket_path,
                                const std::vector<std::string>& ids,
                                FILE* out) 
 {
   std::string result;
   for (const std::string& id : ids) {
-    std::string frontend_url = MakeFrontEndURL(host, port, id);
+    std::string frontend_url;
+    if (unix_socket_path.empty()) {
+      frontend_url = MakeFrontEndURL(host, port, id);
+      fprintf(gLogStream, "v8inspector: Debugger connection SUCCESS; Copy URL and open in Chrom browser:\n%s\n", frontend_url.c_str());
+    } else {
+      frontend_url = FormatWsUnixAddress(unix_socket_path, id, true);
+      fprintf(gLogStream, "v8inspector: Debugger listening on Unix socket:\n%s\n", frontend_url.c_str());
+    }
     if(out)
         fprintf(out, "%s\n", frontend_url.c_str());
-    fprintf(gLogStream, "v8inspector: Debugger connection SUCCESS; Copy URL and open in Chrom browser:\n%s\n", frontend_url.c_str());
 
     result += frontend_url + "\n";
   }
@@ -148,49 +181,242 @@ std::string PrintDebuggerReadyMessage(const std::string& host,
   return result;
 }
 
-void SendHttpResponse(InspectorSocket* socket, const std::string& response) {
-  const char HEADERS[] = "HTTP/1.0 200 OK\r\n"
+// Looks for a "name=<number>" pair in the query.
+bool GetQueryNumber(const std::string& query, const char* name,
+                    size_t* value) {
+  std::string pattern = "&" + std::string(name) + "=";
+  size_t start = ("&" + query).find(pattern);
+  if (start == std::string::npos)
+    return false;
+  const char* digits = query.c_str() + start + pattern.size() - 1;
+  char* end;
+  unsigned long long number = strtoull(digits, &end, 10);
+  if (end == digits || (*end != '\0' && *end != '&'))
+    return false;
+  *value = static_cast<size_t>(number);
+  return true;
+}
+
+std::string MakeETag(const std::string& body) {
+  // FNV-1a, only has to tell versions of the same resource apart.
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : body) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ull;
+  }
+  char etag[24];
+  snprintf(etag, sizeof(etag), "\"%016llx\"",
+           static_cast<unsigned long long>(hash));
+  return etag;
+}
+
+// If-None-Match is "*" or a list of tags, weak ones match as well.
+bool ETagMatches(const std::string& if_none_match, const std::string& etag) {
+  size_t start = 0;
+  while (start < if_none_match.size()) {
+    size_t end = if_none_match.find(',', start);
+    if (end == std::string::npos)
+      end = if_none_match.size();
+    std::string tag = if_none_match.substr(start, end - start);
+    tag.erase(0, tag.find_first_not_of(" \t"));
+    tag.erase(tag.find_last_not_of(" \t") + 1);
+    if (tag.compare(0, 2, "W/") == 0)
+      tag.erase(0, 2);
+    if (tag == "*" || tag == etag)
+      return true;
+    start = end + 1;
+  }
+  return false;
+}
+
+const char* ConnectionHeader(InspectorSocket* socket) {
+  const inspector_http_request* request = inspector_get_request(socket);
+  return request != nullptr && request->keep_alive ? "keep-alive" : "close";
+}
+
+typedef std::shared_ptr<const std::string> SharedBody;
+
+// extra_headers are complete "Name: value\r\n" lines. The header and the
+// body go out in one write, and the body is not copied.
+void SendHttpResponse(InspectorSocket* socket, SharedBody response,
+                      const std::string& extra_headers = std::string(),
+                      const char* cache_control = "no-cache") {
+  const char HEADERS[] = "HTTP/1.1 200 OK\r\n"
                          "Content-Type: application/json; charset=UTF-8\r\n"
-                         "Cache-Control: no-cache\r\n"
-                         "Content-Length: %zu\r\n"
-                         "\r\n";
-  char header[sizeof(HEADERS) + 20];
-  int header_len = snprintf(header, sizeof(header), HEADERS, response.size());
-  inspector_write(socket, header, header_len);
-  inspector_write(socket, response.data(), response.size());
+                         "Cache-Control: %s\r\n"
+                         "Connection: %s\r\n"
+                         "Content-Length: %zu\r\n";
+  char header[sizeof(HEADERS) + 80];
+  int header_len = snprintf(header, sizeof(header), HEADERS, cache_control,
+                            ConnectionHeader(socket), response->size());
+  std::string head(header, header_len);
+  head += extra_headers;
+  head += "\r\n";
+  inspector_write_response(socket, std::move(head), std::move(response));
 }
 
-void SendVersionResponse(InspectorSocket* socket) {
-  std::map<std::string, std::string> response;
-  response["Browser"] = "v8inspector";
-  response["Protocol-Version"] = "1.1";
-  SendHttpResponse(socket, MapToString(response));
+void SendHttpResponse(InspectorSocket* socket, std::string response) {
+  SendHttpResponse(socket, std::make_shared<const std::string>(
+                               std::move(response)));
+}
+
+// Answers 304 Not Modified if the client already has this version.
+bool SendNotModified(InspectorSocket* socket, const std::string& etag,
+                     const char* cache_control) {
+  const inspector_http_request* request = inspector_get_request(socket);
+  if (request == nullptr || !ETagMatches(request->if_none_match, etag))
+    return false;
+  std::string response = "HTTP/1.1 304 Not Modified\r\nCache-Control: ";
+  response += cache_control;
+  response += "\r\nConnection: ";
+  response += ConnectionHeader(socket);
+  response += "\r\nETag: " + etag + "\r\n\r\n";
+  inspector_write(socket, std::move(response));
+  return true;
+}
+
+void SendCachedResponse(InspectorSocket* socket, const SharedBody& body,
+                        const std::string& etag, InspectorStats* stats,
+                        const std::string& extra_headers = std::string(),
+                        const char* cache_control = "no-cache") {
+  StatsAdd(&stats->http_responses, 1);
+  if (SendNotModified(socket, etag, cache_control)) {
+    StatsAdd(&stats->http_not_modified, 1);
+    return;
+  }
+  SendHttpResponse(socket, body, "ETag: " + etag + "\r\n" + extra_headers,
+                   cache_control);
+}
+
+void SendVersionResponse(InspectorSocket* socket, InspectorStats* stats) {
+  // Never changes while the process runs.
+  static const SharedBody body = [] {
+    std::map<std::string, std::string> response;
+    response["Browser"] = "v8inspector";
+    response["Protocol-Version"] = "1.1";
+    return std::make_shared<const std::string>(MapToString(response));
+  }();
+  static const std::string etag = MakeETag(*body);
+  SendCachedResponse(socket, body, etag, stats);
+}
+
+// Whether Accept-Encoding lists coding (or "*") without q=0.
+bool AcceptsEncoding(const std::string& accept_encoding, const char* coding) {
+  size_t start = 0;
+  while (start < accept_encoding.size()) {
+    size_t end = accept_encoding.find(',', start);
+    if (end == std::string::npos)
+      end = accept_encoding.size();
+    std::string item = accept_encoding.substr(start, end - start);
+    start = end + 1;
+    size_t params = item.find(';');
+    std::string name = item.substr(0, params);
+    name.erase(0, name.find_first_not_of(" \t"));
+    name.erase(name.find_last_not_of(" \t") + 1);
+    if (name != "*" && (name.size() != strlen(coding) ||
+                        !StringEqualNoCaseN(name.data(), coding,
+                                            name.size()))) {
+      continue;
+    }
+    if (params != std::string::npos) {
+      size_t q = item.find("q=", params);
+      if (q != std::string::npos && strtod(item.c_str() + q + 2, nullptr) <= 0)
+        return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+uint32_t ProtocolJsonCrc() {
+  return static_cast<uint32_t>(PROTOCOL_JSON[3]) << 24 |
+         static_cast<uint32_t>(PROTOCOL_JSON[4]) << 16 |
+         static_cast<uint32_t>(PROTOCOL_JSON[5]) << 8 |
+         static_cast<uint32_t>(PROTOCOL_JSON[6]);
 }
 
-void SendProtocolJson(InspectorSocket* socket) {
+std::string InflateProtocolJson() {
+  const size_t size = PROTOCOL_JSON[0] * 0x10000u +
+                      PROTOCOL_JSON[1] * 0x100u +
+                      PROTOCOL_JSON[2];
   z_stream strm;
   strm.zalloc = Z_NULL;
   strm.zfree = Z_NULL;
   strm.opaque = Z_NULL;
-
-  // BUGBUG ToFix
-  printf("PROTOCOL_JSON not included!");
-  return;
-
-  assert(Z_OK == inflateInit(&strm));
-  static const size_t kDecompressedSize =
-      PROTOCOL_JSON[0] * 0x10000u +
-      PROTOCOL_JSON[1] * 0x100u +
-      PROTOCOL_JSON[2];
-  strm.next_in = const_cast<uint8_t*>(PROTOCOL_JSON + 3);
-  strm.avail_in = sizeof(PROTOCOL_JSON) - 3;
-  std::string data(kDecompressedSize, '\0');
+  strm.next_in = const_cast<uint8_t*>(PROTOCOL_JSON + kProtocolJsonHeaderSize);
+  strm.avail_in = sizeof(PROTOCOL_JSON) - kProtocolJsonHeaderSize;
+  std::string data(size, '\0');
   strm.next_out = reinterpret_cast<Byte*>(&data[0]);
   strm.avail_out = data.size();
-  assert(Z_STREAM_END == inflate(&strm, Z_FINISH));
+  int err = inflateInit(&strm);
+  assert(err == Z_OK);
+  err = inflate(&strm, Z_FINISH);
+  assert(err == Z_STREAM_END);
   assert(0 == strm.avail_out);
-  assert(Z_OK == inflateEnd(&strm));
-  SendHttpResponse(socket, data);
+  inflateEnd(&strm);
+  (void) err;
+  return data;
+}
+
+// The embedded zlib stream rewrapped as gzip: its deflate data between a
+// gzip header and a trailer of CRC-32 and size, both little endian.
+std::string ProtocolJsonAsGzip() {
+  static const uint8_t kGzipHeader[] = {
+    0x1f, 0x8b, 8 /* deflate */, 0, 0, 0, 0, 0, 0, 0xff /* unknown OS */
+  };
+  const size_t kZlibHeaderSize = 2;
+  const size_t kZlibTrailerSize = 4;  // Adler-32
+  const uint8_t* deflated =
+      PROTOCOL_JSON + kProtocolJsonHeaderSize + kZlibHeaderSize;
+  size_t deflated_size = sizeof(PROTOCOL_JSON) - kProtocolJsonHeaderSize -
+                         kZlibHeaderSize - kZlibTrailerSize;
+  uint32_t crc = ProtocolJsonCrc();
+  uint32_t size = PROTOCOL_JSON[0] * 0x10000u + PROTOCOL_JSON[1] * 0x100u +
+                  PROTOCOL_JSON[2];
+  std::string gzip(reinterpret_cast<const char*>(kGzipHeader),
+                   sizeof(kGzipHeader));
+  gzip.append(reinterpret_cast<const char*>(deflated), deflated_size);
+  for (int shift = 0; shift < 32; shift += 8)
+    gzip.push_back(static_cast<char>((crc >> shift) & 0xff));
+  for (int shift = 0; shift < 32; shift += 8)
+    gzip.push_back(static_cast<char>((size >> shift) & 0xff));
+  return gzip;
+}
+
+// The schema is fixed for the life of the process: compressed clients get
+// the embedded stream as it is, the rest a copy inflated on first use.
+void SendProtocolJson(InspectorSocket* socket, InspectorStats* stats) {
+  static const char kCacheControl[] = "public, max-age=86400";
+  const inspector_http_request* request = inspector_get_request(socket);
+  const std::string& accept =
+      request != nullptr ? request->accept_encoding : std::string();
+  char crc[12];
+  snprintf(crc, sizeof(crc), "%08x", ProtocolJsonCrc());
+  const char* coding = nullptr;
+  if (AcceptsEncoding(accept, "gzip")) {
+    static const SharedBody gzip =
+        std::make_shared<const std::string>(ProtocolJsonAsGzip());
+    coding = "gzip";
+    SendCachedResponse(socket, gzip, "\"" + std::string(crc) + "-gzip\"",
+                       stats, "Content-Encoding: gzip\r\n"
+                              "Vary: Accept-Encoding\r\n", kCacheControl);
+  } else if (AcceptsEncoding(accept, "deflate")) {
+    static const SharedBody deflate = std::make_shared<const std::string>(
+        reinterpret_cast<const char*>(PROTOCOL_JSON) + kProtocolJsonHeaderSize,
+        sizeof(PROTOCOL_JSON) - kProtocolJsonHeaderSize);
+    coding = "deflate";
+    SendCachedResponse(socket, deflate,
+                       "\"" + std::string(crc) + "-deflate\"", stats,
+                       "Content-Encoding: deflate\r\n"
+                       "Vary: Accept-Encoding\r\n", kCacheControl);
+  } else {
+    static const SharedBody json =
+        std::make_shared<const std::string>(InflateProtocolJson());
+    SendCachedResponse(socket, json, "\"" + std::string(crc) + "\"", stats,
+                       "Vary: Accept-Encoding\r\n", kCacheControl);
+  }
+  if (coding != nullptr)
+    StatsAdd(&stats->http_compressed_responses, 1);
 }
 
 int GetSocketHost(uv_tcp_t* socket, std::string* out_host) {
@@ -258,16 +484,29 @@ class SocketSession {
  public:
   static int Accept(InspectorSocketServer* server, int server_port,
                     uv_stream_t* server_socket);
-  void Send(const std::string& message);
+  void Send(std::string message);
   void Close();
+  void Cork() { inspector_cork(&socket_); }
+  void Uncork() { inspector_uncork(&socket_); }
+  void Ping() {
+    if (state_ == State::kWebSocket)
+      inspector_ping(&socket_);
+  }
+  uint64_t rtt_ns() const { return inspector_rtt_ns(&socket_); }
 
   int id() const { return id_; }
-  bool IsForTarget(const std::string& target_id) const {
-    return target_id_ == target_id;
-  }
+  bool congested() const { return congested_; }
+  const std::string& target_id() const { return target_id_; }
   static int ServerPortForClient(InspectorSocket* client) {
     return From(client)->server_port_;
   }
+  // Local address the client connected to, looked up once per connection.
+  static const std::string& LocalHostForClient(InspectorSocket* client) {
+    SocketSession* session = From(client);
+    if (session->local_host_.empty() && client->tcp.type == UV_TCP)
+      GetSocketHost(&client->tcp, &session->local_host_);
+    return session->local_host_;
+  }
 
  private:
   SocketSession(InspectorSocketServer* server, int server_port);
@@ -279,12 +518,16 @@ class SocketSession {
   static bool HandshakeCallback(InspectorSocket* socket,
                                 enum inspector_handshake_event state,
                                 const std::string& path);
-  static void ReadCallback(uv_stream_t* stream, ssize_t read,
-                           const uv_buf_t* buf);
+  static void MessageCallback(InspectorSocket* socket, int status,
+                              const char* data, size_t len,
+                              inspector_message_type type);
   static void CloseCallback(InspectorSocket* socket, int code);
+  static void WrittenCallback(InspectorSocket* socket, int status);
 
   void FrontendConnected();
+  void CheckWritePressure();
   void SetDeclined() { state_ = State::kDeclined; }
+  void SetCborResponses() { cbor_responses_ = true; }
   void SetTargetId(const std::string& target_id) {
     assert(target_id_.empty());
     target_id_ = target_id;
@@ -296,12 +539,19 @@ class SocketSession {
   std::string target_id_;
   State state_;
   const int server_port_;
+  std::string local_host_;
+  bool congested_;
+  // Opted in with ws://host:port/<target>?format=cbor, messages to the
+  // frontend go out as binary CBOR frames.
+  bool cbor_responses_;
 };
 
 class ServerSocket {
  public:
   static int Listen(InspectorSocketServer* inspector_server,
                     sockaddr* addr, uv_loop_t* loop);
+  static int ListenPipe(InspectorSocketServer* inspector_server,
+                        const std::string& path, uv_loop_t* loop);
   void Close() {
     uv_close(reinterpret_cast<uv_handle_t*>(&tcp_socket_),
              SocketClosedCallback);
@@ -311,6 +561,7 @@ class ServerSocket {
  private:
   explicit ServerSocket(InspectorSocketServer* server)
       : tcp_socket_(uv_tcp_t()), server_(server), port_(-1) {}
+  int BindPipe(const std::string& path);
   template<typename UvHandle>
   static ServerSocket* FromTcpSocket(UvHandle* socket) {
     return ContainerOf(&ServerSocket::tcp_socket_,
@@ -324,29 +575,45 @@ class ServerSocket {
   }
   int DetectPort();
 
-  uv_tcp_t tcp_socket_;
+  // tcp_socket_ is also used to refer to pipe_socket_ as a handle or stream.
+  union {
+    uv_tcp_t tcp_socket_;
+    uv_pipe_t pipe_socket_;
+  };
   InspectorSocketServer* server_;
   int port_;
+  // Socket file to remove once closed, if one was created.
+  std::string unlink_path_;
 };
 
 InspectorSocketServer::InspectorSocketServer(SocketServerDelegate* delegate,
                                              uv_loop_t* loop,
                                              const std::string& host,
                                              int port,
+                                             const InspectorOptions& options,
+                                             InspectorStats* stats,
                                              FILE* out) : loop_(loop),
                                                           delegate_(delegate),
                                                           host_(host),
                                                           port_(port),
                                                           closer_(nullptr),
                                                           next_session_id_(0),
+                                                          options_(options),
+                                                          stats_(stats),
+                                                          read_pool_(stats),
+                                                          list_generation_(1),
                                                           out_(out) {
   state_ = ServerState::kNew;
 }
 
 bool InspectorSocketServer::SessionStarted(SocketSession* session,
                                            const std::string& id) {
-  if (TargetExists(id) && delegate_->StartSession(session->id(), id)) {
+  auto target = targets_.find(id);
+  if (target != targets_.end() &&
+      delegate_->StartSession(session->id(), id)) {
     connected_sessions_[session->id()] = session;
+    target->second.sessions++;
+    list_generation_++;
     return true;
   } else {
     return false;
@@ -356,11 +623,18 @@ bool InspectorSocketServer::SessionStarted(SocketSession* session,
 void InspectorSocketServer::SessionTerminated(SocketSession* session) {
   int id = session->id();
   if (connected_sessions_.erase(id) != 0) {
+    auto target = targets_.find(session->target_id());
+    if (target != targets_.end())
+      target->second.sessions--;
+    list_generation_++;
+    if (session->congested())
+      delegate_->WritePressureChanged(id, false);
     delegate_->EndSession(id);
     if (connected_sessions_.empty()) {
       if (state_ == ServerState::kRunning && !server_sockets_.empty()) {
         PrintDebuggerReadyMessage(host_, server_sockets_[0]->port(),
-                                  delegate_->GetTargetIds(), out_);
+                                  options_.unix_socket_path,
+                                  target_ids_, out_);
       }
       if (state_ == ServerState::kStopped) {
         delegate_->ServerDone();
@@ -373,18 +647,28 @@ void InspectorSocketServer::SessionTerminated(SocketSession* session) {
 bool InspectorSocketServer::HandleGetRequest(InspectorSocket* socket,
                                              const std::string& path) {
   
-  const char* command = MatchPathSegment(path.c_str(), "/json");
+  std::string resource = path;
+  std::string query;
+  size_t query_start = resource.find('?');
+  if (query_start != std::string::npos) {
+    query = resource.substr(query_start + 1);
+    resource.resize(query_start);
+  }
+  const char* command = MatchPathSegment(resource.c_str(), "/json");
   if (command == nullptr)
     return false;
 
   if (MatchPathSegment(command, "list") || command[0] == '\0') {
-    SendListResponse(socket);
+    SendListResponse(socket, query);
     return true;
   } else if (MatchPathSegment(command, "protocol")) {
-    SendProtocolJson(socket);
+    SendProtocolJson(socket, stats_);
     return true;
   } else if (MatchPathSegment(command, "version")) {
-    SendVersionResponse(socket);
+    SendVersionResponse(socket, stats_);
+    return true;
+  } else if (MatchPathSegment(command, "stats")) {
+    SendStatsResponse(socket);
     return true;
   } else if (const char* target_id = MatchPathSegment(command, "activate")) {
     if (TargetExists(target_id)) {
@@ -397,32 +681,59 @@ bool InspectorSocketServer::HandleGetRequest(InspectorSocket* socket,
 
 }
 
-void InspectorSocketServer::SendListResponse(InspectorSocket* socket) {
-  std::vector<std::map<std::string, std::string>> response;
-  for (const std::string& id : delegate_->GetTargetIds()) {
-    response.push_back(std::map<std::string, std::string>());
-    std::map<std::string, std::string>& target_map = response.back();
+void InspectorSocketServer::SendListResponse(InspectorSocket* socket,
+                                             const std::string& query) {
+  const std::string& host = SocketSession::LocalHostForClient(socket);
+  int port = SocketSession::ServerPortForClient(socket);
+  TargetListCache& cache = list_cache_[FormatWsAddress(host, port, "", false)];
+  if (cache.generation != list_generation_)
+    BuildTargetList(host, port, &cache);
+
+  // ?offset=N&limit=M returns a slice, the full count is in X-Total-Count.
+  size_t offset = 0;
+  size_t limit = SIZE_MAX;
+  bool paged = GetQueryNumber(query, "offset", &offset);
+  paged = GetQueryNumber(query, "limit", &limit) || paged;
+  if (!paged) {
+    SendCachedResponse(socket, cache.body, cache.etag, stats_);
+    return;
+  }
+  size_t total = cache.targets.size();
+  offset = std::min(offset, total);
+  size_t end = offset + std::min(limit, total - offset);
+  std::vector<std::string> page(cache.targets.begin() + offset,
+                                cache.targets.begin() + end);
+  std::string etag = cache.etag;
+  etag.insert(etag.size() - 1,
+              "-" + std::to_string(offset) + "-" + std::to_string(end));
+  SendCachedResponse(socket,
+                     std::make_shared<const std::string>(JoinJsonArray(page)),
+                     etag, stats_,
+                     "X-Total-Count: " + std::to_string(total) + "\r\n");
+}
+
+void InspectorSocketServer::BuildTargetList(const std::string& host, int port,
+                                            TargetListCache* cache) {
+  StatsAdd(&stats_->target_list_builds, 1);
+  cache->targets.clear();
+  for (const std::string& id : target_ids_) {
+    const TargetInfo& target = targets_.find(id)->second;
+    std::map<std::string, std::string> target_map;
     target_map["description"] = "v8inspector instance";
     target_map["id"] = id;
-    target_map["title"] = delegate_->GetTargetTitle(id);
+    target_map["title"] = target.title;
     Escape(&target_map["title"]);
     target_map["type"] = "node";
     // This attribute value is a "best effort" URL that is passed as a JSON
     // string. It is not guaranteed to resolve to a valid resource.
-    target_map["url"] = delegate_->GetTargetUrl(id);
+    target_map["url"] = target.url;
     Escape(&target_map["url"]);
 
-    bool connected = false;
-    for (const auto& session : connected_sessions_) {
-      if (session.second->IsForTarget(id)) {
-        connected = true;
-        break;
-      }
-    }
-    if (!connected) {
-      std::string host;
-      int port = SocketSession::ServerPortForClient(socket);
-      GetSocketHost(&socket->tcp, &host);
+    bool connected = target.sessions > 0;
+    if (!connected && !options_.unix_socket_path.empty()) {
+      target_map["webSocketDebuggerUrl"] =
+          FormatWsUnixAddress(options_.unix_socket_path, id, true);
+    } else if (!connected) {
       std::ostringstream frontend_url;
       frontend_url << "chrome-devtools://devtools/bundled";
       frontend_url << "/js_app.html?experiments=true&v8only=true&ws=";
@@ -431,18 +742,112 @@ void InspectorSocketServer::SendListResponse(InspectorSocket* socket) {
       target_map["webSocketDebuggerUrl"] =
           FormatWsAddress(host, port, id, true);
     }
+    cache->targets.push_back(MapToString(target_map));
+  }
+  cache->body = std::make_shared<const std::string>(
+      JoinJsonArray(cache->targets));
+  cache->etag = MakeETag(*cache->body);
+  cache->generation = list_generation_;
+}
+
+void InspectorSocketServer::SendStatsResponse(InspectorSocket* socket) {
+  std::map<std::string, std::string> response;
+  auto add = [&response](const char* name, const StatsCounter& counter) {
+    response[name] = std::to_string(counter.load(std::memory_order_relaxed));
+  };
+  add("deflateMessages", stats_->deflate_messages);
+  add("deflateRawBytes", stats_->deflate_raw_bytes);
+  add("deflateCompressedBytes", stats_->deflate_compressed_bytes);
+  add("deflateTimeNs", stats_->deflate_time_ns);
+  add("inflateMessages", stats_->inflate_messages);
+  add("inflateCompressedBytes", stats_->inflate_compressed_bytes);
+  add("inflateRawBytes", stats_->inflate_raw_bytes);
+  add("inflateTimeNs", stats_->inflate_time_ns);
+  add("socketWrites", stats_->socket_writes);
+  add("socketWriteFrames", stats_->socket_write_frames);
+  add("socketWriteBytes", stats_->socket_write_bytes);
+  add("textMessagesIn", stats_->text_messages_in);
+  add("textAsciiMessagesIn", stats_->text_ascii_messages_in);
+  add("textInvalidMessagesIn", stats_->text_invalid_messages_in);
+  add("httpResponses", stats_->http_responses);
+  add("httpNotModified", stats_->http_not_modified);
+  add("httpCompressedResponses", stats_->http_compressed_responses);
+  add("targetListBuilds", stats_->target_list_builds);
+  add("pingsSent", stats_->pings_sent);
+  add("pongsReceived", stats_->pongs_received);
+  for (const auto& session : connected_sessions_) {
+    uint64_t rtt = session.second->rtt_ns();
+    if (rtt != 0) {
+      response["session" + std::to_string(session.first) + "RttUs"] =
+          std::to_string(rtt / 1000);
+    }
+  }
+  add("cborMessagesIn", stats_->cbor_messages_in);
+  add("cborMessagesOut", stats_->cbor_messages_out);
+  add("cborJsonBytesOut", stats_->cbor_json_bytes_out);
+  add("cborBytesOut", stats_->cbor_bytes_out);
+  add("readPoolHits", stats_->read_pool_hits);
+  add("readPoolMisses", stats_->read_pool_misses);
+  add("backpressureEvents", stats_->backpressure_events);
+  add("backpressureBlocks", stats_->backpressure_blocks);
+  add("backpressureBlockedNs", stats_->backpressure_blocked_ns);
+  add("backpressureDropped", stats_->backpressure_dropped);
+  add("backpressureDisconnects", stats_->backpressure_disconnects);
+  add("wakeupsInterrupt", stats_->wakeups_interrupt);
+  add("wakeupsTask", stats_->wakeups_task);
+  add("wakeupsUvAsync", stats_->wakeups_uv_async);
+  add("wakeupsPaused", stats_->wakeups_paused);
+  add("wakeupDispatches", stats_->wakeup_dispatches);
+  add("wakeupLatencyNs", stats_->wakeup_latency_ns);
+  add("priorityMessages", stats_->priority_messages);
+  add("priorityQueueDelayNs", stats_->priority_queue_delay_ns);
+  add("normalMessages", stats_->normal_messages);
+  add("normalQueueDelayNs", stats_->normal_queue_delay_ns);
+  switch (options_.backpressure_policy) {
+  case BackpressurePolicy::kBlock:
+    response["backpressurePolicy"] = "block";
+    break;
+  case BackpressurePolicy::kDropNotifications:
+    response["backpressurePolicy"] = "drop";
+    break;
+  case BackpressurePolicy::kDisconnect:
+    response["backpressurePolicy"] = "disconnect";
+    break;
+  }
+  uint64_t compressed = stats_->deflate_compressed_bytes;
+  if (compressed > 0) {
+    char ratio[32];
+    snprintf(ratio, sizeof(ratio), "%.2f",
+             static_cast<double>(stats_->deflate_raw_bytes) / compressed);
+    response["deflateRatio"] = ratio;
   }
-  SendHttpResponse(socket, MapsToString(response));
+  SendHttpResponse(socket, MapToString(response));
 }
 
 bool InspectorSocketServer::Start(std::string &debugURL) {
   assert(state_ == ServerState::kNew);
+  TargetsChanged();
+  if (!options_.unix_socket_path.empty()) {
+    int err = ServerSocket::ListenPipe(this, options_.unix_socket_path, loop_);
+    if (err != 0) {
+      if (out_ != NULL) {
+        fprintf(out_, "v8inspector: Starting inspector on %s failed: %s\n",
+                options_.unix_socket_path.c_str(), uv_strerror(err));
+        fflush(out_);
+      }
+      return false;
+    }
+    return StartRunning(debugURL);
+  }
   struct addrinfo hints;
   memset(&hints, 0, sizeof(hints));
   hints.ai_flags = AI_NUMERICSERV;
   hints.ai_socktype = SOCK_STREAM;
   uv_getaddrinfo_t req;
   const std::string port_string = std::to_string(port_);
+  // Resolved synchronously. Start() runs on the IO thread before its loop
+  // does anything else, so waiting here holds up no one but the IO thread;
+  // the main thread does not wait for it (see InspectorIo::Launch()).
   int err = uv_getaddrinfo(loop_, &req, nullptr, host_.c_str(),
                            port_string.c_str(), &hints);
   if (err < 0) {
@@ -471,10 +876,23 @@ bool InspectorSocketServer::Start(std::string &debugURL) {
     }
     return false;
   }
+  return StartRunning(debugURL);
+}
+
+bool InspectorSocketServer::StartRunning(std::string &debugURL) {
   state_ = ServerState::kRunning;
+  if (options_.ping_interval_ms > 0) {
+    uv_timer_init(loop_, &ping_timer_);
+    ping_timer_.data = this;
+    uv_timer_start(&ping_timer_, PingTimerCallback, options_.ping_interval_ms,
+                   options_.ping_interval_ms);
+    // Sessions keep the loop alive, the timer on its own does not.
+    uv_unref(reinterpret_cast<uv_handle_t*>(&ping_timer_));
+  }
   // getaddrinfo sorts the addresses, so the first port is most relevant.
   debugURL = PrintDebuggerReadyMessage(host_, server_sockets_[0]->port(),
-                            delegate_->GetTargetIds(), out_);
+                            options_.unix_socket_path,
+                            target_ids_, out_);
   return true;
 }
 
@@ -486,27 +904,83 @@ void InspectorSocketServer::Stop(ServerCallback cb) {
   closer_->AddCallback(cb);
   closer_->IncreaseExpectedCount();
   state_ = ServerState::kStopping;
+  if (options_.ping_interval_ms > 0)
+    uv_close(reinterpret_cast<uv_handle_t*>(&ping_timer_), nullptr);
   for (ServerSocket* server_socket : server_sockets_)
     server_socket->Close();
   closer_->NotifyIfDone();
 }
 
+void InspectorSocketServer::Cork() {
+  for (const auto& session : connected_sessions_) {
+    session.second->Cork();
+  }
+}
+
+void InspectorSocketServer::Uncork() {
+  for (const auto& session : connected_sessions_) {
+    session.second->Uncork();
+  }
+}
+
+// static
+void InspectorSocketServer::PingTimerCallback(uv_timer_t* timer) {
+  InspectorSocketServer* server =
+      static_cast<InspectorSocketServer*>(timer->data);
+  for (const auto& session : server->connected_sessions_) {
+    session.second->Ping();
+  }
+}
+
 void InspectorSocketServer::TerminateConnections() {
   for (const auto& session : connected_sessions_) {
     session.second->Close();
   }
 }
 
-bool InspectorSocketServer::TargetExists(const std::string& id) {
-  const std::vector<std::string>& target_ids = delegate_->GetTargetIds();
-  const auto& found = std::find(target_ids.begin(), target_ids.end(), id);
-  return found != target_ids.end();
+void InspectorSocketServer::AddTarget(const std::string& id,
+                                      const std::string& title,
+                                      const std::string& url) {
+  auto inserted = targets_.emplace(id, TargetInfo());
+  if (inserted.second)
+    target_ids_.push_back(id);
+  inserted.first->second.title = title;
+  inserted.first->second.url = url;
+  list_generation_++;
+}
+
+void InspectorSocketServer::RemoveTarget(const std::string& id) {
+  if (targets_.erase(id) == 0)
+    return;
+  target_ids_.erase(std::remove(target_ids_.begin(), target_ids_.end(), id),
+                    target_ids_.end());
+  list_generation_++;
+}
+
+void InspectorSocketServer::TargetsChanged() {
+  std::unordered_map<std::string, TargetInfo> targets;
+  std::vector<std::string> ids;
+  for (const std::string& id : delegate_->GetTargetIds()) {
+    auto inserted = targets.emplace(id, TargetInfo());
+    if (!inserted.second)
+      continue;
+    ids.push_back(id);
+    TargetInfo& target = inserted.first->second;
+    target.title = delegate_->GetTargetTitle(id);
+    target.url = delegate_->GetTargetUrl(id);
+    auto previous = targets_.find(id);
+    if (previous != targets_.end())
+      target.sessions = previous->second.sessions;
+  }
+  targets_.swap(targets);
+  target_ids_.swap(ids);
+  list_generation_++;
 }
 
-void InspectorSocketServer::Send(int session_id, const std::string& message) {
+void InspectorSocketServer::Send(int session_id, std::string message) {
   auto session_iterator = connected_sessions_.find(session_id);
   if (session_iterator != connected_sessions_.end()) {
-    session_iterator->second->Send(message);
+    session_iterator->second->Send(std::move(message));
   }
 }
 
@@ -544,7 +1018,14 @@ SocketSession::SocketSession(InspectorSocketServer* server, int server_port)
                              : id_(server->GenerateSessionId()),
                                server_(server),
                                state_(State::kHttp),
-                               server_port_(server_port) { }
+                               server_port_(server_port),
+                               congested_(false),
+                               cbor_responses_(false) {
+  socket_.options = &server->options();
+  socket_.stats = server->stats();
+  socket_.read_pool = server->read_pool();
+  socket_.written_cb = WrittenCallback;
+}
 
 void SocketSession::Close() {
   assert(state_ != State::kClosing);
@@ -571,11 +1052,13 @@ bool SocketSession::HandshakeCallback(InspectorSocket* socket,
                                       const std::string& path) {
   SocketSession* session = SocketSession::From(socket);
   InspectorSocketServer* server = session->server_;
-  const std::string& id = path.empty() ? path : path.substr(1);
+  std::string id = path.empty() ? path : path.substr(1);
   switch (event) {
   case kInspectorHandshakeHttpGet:
     return server->HandleGetRequest(socket, path);
   case kInspectorHandshakeUpgrading:
+    if (SplitQueryParameter(&id, "format=cbor"))
+      session->SetCborResponses();
     if (server->SessionStarted(session, id)) {
       session->SetTargetId(id);
       return true;
@@ -602,29 +1085,79 @@ void SocketSession::CloseCallback(InspectorSocket* socket, int code) {
   session->server_->SessionTerminated(session);
 }
 
+// static
+void SocketSession::WrittenCallback(InspectorSocket* socket, int status) {
+  SocketSession::From(socket)->CheckWritePressure();
+}
+
+void SocketSession::CheckWritePressure() {
+  if (state_ != State::kWebSocket)
+    return;
+  const InspectorOptions& options = server_->options();
+  size_t queued = inspector_write_queue_size(&socket_);
+  if (!congested_ && queued >= options.write_queue_high_watermark) {
+    StatsAdd(&server_->stats()->backpressure_events, 1);
+    if (options.backpressure_policy == BackpressurePolicy::kDisconnect) {
+      StatsAdd(&server_->stats()->backpressure_disconnects, 1);
+      Close();
+      return;
+    }
+    congested_ = true;
+    server_->WritePressureChanged(id_, true);
+  } else if (congested_ && queued <= options.write_queue_low_watermark) {
+    congested_ = false;
+    server_->WritePressureChanged(id_, false);
+  }
+}
+
 void SocketSession::FrontendConnected() {
   assert(State::kHttp == state_);
   state_ = State::kWebSocket;
-  inspector_read_start(&socket_, OnBufferAlloc, ReadCallback);
+  inspector_read_start(&socket_, MessageCallback);
 }
 
 // static
-void SocketSession::ReadCallback(uv_stream_t* stream, ssize_t read,
-                                 const uv_buf_t* buf) {
-  InspectorSocket* socket = inspector_from_stream(stream);
+void SocketSession::MessageCallback(InspectorSocket* socket, int status,
+                                    const char* data, size_t len,
+                                    inspector_message_type type) {
   SocketSession* session = SocketSession::From(socket);
-  if (read > 0) {
-    session->server_->MessageReceived(session->id_,
-                                      std::string(buf->base, read));
+  if (status == 0 && type == kInspectorMessageBinary) {
+    // V8 only takes JSON, CBOR is translated here on the IO thread. Its text
+    // strings are copied as they are, so the result is checked like a text
+    // frame would be.
+    std::string json;
+    Utf8Kind kind = Utf8Kind::kInvalid;
+    if (CborToJson(data, len, &json))
+      kind = ClassifyUtf8(json.data(), json.size());
+    if (kind != Utf8Kind::kInvalid) {
+      StatsAdd(&session->server_->stats()->cbor_messages_in, 1);
+      session->server_->MessageReceived(session->id_, std::move(json),
+                                        kind == Utf8Kind::kAscii);
+    } else {
+      session->Close();
+    }
+  } else if (status == 0) {
+    session->server_->MessageReceived(session->id_, std::string(data, len),
+                                      type == kInspectorMessageAscii);
   } else {
     session->Close();
   }
-  if (buf != nullptr && buf->base != nullptr)
-    delete[] buf->base;
 }
 
-void SocketSession::Send(const std::string& message) {
-  inspector_write(&socket_, message.data(), message.length());
+void SocketSession::Send(std::string message) {
+  if (state_ == State::kClosing)
+    return;
+  std::string cbor;
+  if (cbor_responses_ && JsonToCbor(message.data(), message.size(), &cbor)) {
+    InspectorStats* stats = server_->stats();
+    StatsAdd(&stats->cbor_messages_out, 1);
+    StatsAdd(&stats->cbor_json_bytes_out, message.size());
+    StatsAdd(&stats->cbor_bytes_out, cbor.size());
+    inspector_write(&socket_, std::move(cbor), true);
+  } else {
+    inspector_write(&socket_, std::move(message));
+  }
+  CheckWritePressure();
 }
 
 // ServerSocket implementation
@@ -649,8 +1182,9 @@ int ServerSocket::Listen(InspectorSocketServer* inspector_server,
                          sockaddr* addr, uv_loop_t* loop) {
   ServerSocket* server_socket = new ServerSocket(inspector_server);
   uv_tcp_t* server = &server_socket->tcp_socket_;
-  assert(0 == uv_tcp_init(loop, server));
-  int err = uv_tcp_bind(server, addr, 0);
+  int err = uv_tcp_init(loop, server);
+  assert(err == 0);
+  err = uv_tcp_bind(server, addr, 0);
   if (err == 0) {
     err = uv_listen(reinterpret_cast<uv_stream_t*>(server), 1,
                     ServerSocket::SocketConnectedCallback);
@@ -666,6 +1200,75 @@ int ServerSocket::Listen(InspectorSocketServer* inspector_server,
   return err;
 }
 
+int ServerSocket::BindPipe(const std::string& path) {
+#ifdef _WIN32
+  return uv_pipe_bind(&pipe_socket_, path.c_str());
+#else
+  if (path[0] != '@') {
+    // A socket file left behind by a process that did not exit cleanly
+    // would make the bind fail.
+    struct stat info;
+    if (lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+      unlink(path.c_str());
+    int err = uv_pipe_bind(&pipe_socket_, path.c_str());
+    if (err == 0)
+      unlink_path_ = path;
+    return err;
+  }
+#ifdef __linux__
+  // libuv only binds paths, an abstract name is bound here and the socket
+  // handed over.
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() > sizeof(addr.sun_path))
+    return UV_ENAMETOOLONG;
+  memcpy(addr.sun_path + 1, path.data() + 1, path.size() - 1);
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    return -errno;
+  socklen_t len = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) +
+                                         path.size());
+  int err = 0;
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), len) != 0)
+    err = -errno;
+  if (err == 0)
+    err = uv_pipe_open(&pipe_socket_, fd);
+  if (err != 0)
+    close(fd);
+  return err;
+#else
+  return UV_ENOTSUP;
+#endif  // __linux__
+#endif  // _WIN32
+}
+
+// static
+int ServerSocket::ListenPipe(InspectorSocketServer* inspector_server,
+                             const std::string& path, uv_loop_t* loop) {
+  ServerSocket* server_socket = new ServerSocket(inspector_server);
+  uv_pipe_t* server = &server_socket->pipe_socket_;
+  int err = uv_pipe_init(loop, server, 0);
+  assert(err == 0);
+  err = server_socket->BindPipe(path);
+  if (err == 0) {
+    err = uv_listen(reinterpret_cast<uv_stream_t*>(server), 1,
+                    ServerSocket::SocketConnectedCallback);
+  }
+  if (err == 0) {
+    // There is no port, 0 keeps the /json/list cache key apart from TCP.
+    server_socket->port_ = 0;
+    inspector_server->ServerSocketListening(server_socket);
+  } else {
+#ifndef _WIN32
+    if (!server_socket->unlink_path_.empty())
+      unlink(server_socket->unlink_path_.c_str());
+#endif
+    uv_close(reinterpret_cast<uv_handle_t*>(server), FreeOnCloseCallback);
+  }
+  return err;
+}
+
 // static
 void ServerSocket::SocketConnectedCallback(uv_stream_t* tcp_socket,
                                            int status) {
@@ -680,6 +1283,10 @@ void ServerSocket::SocketConnectedCallback(uv_stream_t* tcp_socket,
 // static
 void ServerSocket::SocketClosedCallback(uv_handle_t* tcp_socket) {
   ServerSocket* server_socket = ServerSocket::FromTcpSocket(tcp_socket);
+#ifndef _WIN32
+  if (!server_socket->unlink_path_.empty())
+    unlink(server_socket->unlink_path_.c_str());
+#endif
   server_socket->server_->ServerSocketClosed(server_socket);
   delete server_socket;
 }
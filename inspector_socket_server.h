@@ -24,11 +24,15 @@
 #define SRC_INSPECTOR_SOCKET_SERVER_H_
 
 #include "inspector_agent.h"
+#include "inspector_options.h"
 #include "inspector_socket.h"
+#include "inspector_stats.h"
 #include "uv.h"
 
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace inspector {
@@ -41,11 +45,18 @@ class SocketServerDelegate {
  public:
   virtual bool StartSession(int session_id, const std::string& target_id) = 0;
   virtual void EndSession(int session_id) = 0;
-  virtual void MessageReceived(int session_id, const std::string& message) = 0;
+  // ascii is set if the message is known to be 7-bit ASCII, which V8 can
+  // take as is.
+  virtual void MessageReceived(int session_id, std::string message,
+                               bool ascii) = 0;
   virtual std::vector<std::string> GetTargetIds() = 0;
   virtual std::string GetTargetTitle(const std::string& id) = 0;
   virtual std::string GetTargetUrl(const std::string& id) = 0;
   virtual void ServerDone() = 0;
+  // The session's write queue went over the high watermark (congested) or
+  // back under the low watermark. Every congested report is followed by a
+  // relief report, at the latest when the session ends.
+  virtual void WritePressureChanged(int session_id, bool congested) {}
 };
 
 // HTTP Server, writes messages requested as TransportActions, and responds
@@ -60,17 +71,24 @@ class InspectorSocketServer {
                         uv_loop_t* loop,
                         const std::string& host,
                         int port,
+                        const InspectorOptions& options,
+                        InspectorStats* stats,
                         FILE* out = stderr);
-  // Start listening on host/port
+  // Start listening on host/port. Blocks while the host is resolved, so it
+  // is called on the IO thread.
   bool Start(std::string &debugURL);
 
   // Called by the TransportAction sent with InspectorIo::Write():
   //   kKill and kStop
   void Stop(ServerCallback callback);
   //   kSendMessage
-  void Send(int session_id, const std::string& message);
+  void Send(int session_id, std::string message);
   //   kKill
   void TerminateConnections();
+  // Bracket a drain of the outgoing queue, frames sent in between are
+  // coalesced into as few socket writes as possible.
+  void Cork();
+  void Uncork();
 
   int Port() const;
 
@@ -82,17 +100,49 @@ class InspectorSocketServer {
   bool HandleGetRequest(InspectorSocket* socket, const std::string& path);
   bool SessionStarted(SocketSession* session, const std::string& id);
   void SessionTerminated(SocketSession* session);
-  void MessageReceived(int session_id, const std::string& message) {
-    delegate_->MessageReceived(session_id, message);
+  void MessageReceived(int session_id, std::string message, bool ascii) {
+    delegate_->MessageReceived(session_id, std::move(message), ascii);
   }
+  void WritePressureChanged(int session_id, bool congested) {
+    delegate_->WritePressureChanged(session_id, congested);
+  }
+  // The server keeps its own registry of the delegate's targets, so that
+  // handshakes and list requests do not query the delegate. It is loaded in
+  // Start(), and kept current with these as InspectorIo passes on target
+  // updates. Session attachment is tracked by the server itself.
+  void AddTarget(const std::string& id, const std::string& title,
+                 const std::string& url);
+  void RemoveTarget(const std::string& id);
+  // Reloads all targets from the delegate.
+  void TargetsChanged();
 
   int GenerateSessionId() {
     return next_session_id_++;
   }
 
+  const InspectorOptions& options() const { return options_; }
+  InspectorStats* stats() { return stats_; }
+  ReadBufferPool* read_pool() { return &read_pool_; }
+
  private:
-  void SendListResponse(InspectorSocket* socket);
-  bool TargetExists(const std::string& id);
+  // /json/list as served on one local address.
+  struct TargetListCache {
+    uint64_t generation = 0;
+    std::vector<std::string> targets;  // One JSON object per target
+    // Shared with responses still being written when the list is rebuilt.
+    std::shared_ptr<const std::string> body;
+    std::string etag;
+  };
+  void SendListResponse(InspectorSocket* socket, const std::string& query);
+  void BuildTargetList(const std::string& host, int port,
+                       TargetListCache* cache);
+  void SendStatsResponse(InspectorSocket* socket);
+  bool TargetExists(const std::string& id) const {
+    return targets_.count(id) != 0;
+  }
+  // Common to the TCP and Unix socket paths of Start().
+  bool StartRunning(std::string &debugURL);
+  static void PingTimerCallback(uv_timer_t* timer);
 
   enum class ServerState {kNew, kRunning, kStopping, kStopped};
   uv_loop_t* loop_;
@@ -104,6 +154,23 @@ class InspectorSocketServer {
   Closer* closer_;
   std::map<int, SocketSession*> connected_sessions_;
   int next_session_id_;
+  const InspectorOptions options_;
+  InspectorStats* const stats_;
+  // Read buffers of all sessions, released before the server goes away.
+  ReadBufferPool read_pool_;
+  // Pings all sessions every InspectorOptions::ping_interval_ms.
+  uv_timer_t ping_timer_;
+  struct TargetInfo {
+    std::string title;
+    std::string url;
+    int sessions = 0;  // Attached to the target
+  };
+  std::unordered_map<std::string, TargetInfo> targets_;
+  // Ids of targets_ in the order they were reported.
+  std::vector<std::string> target_ids_;
+  // Keyed by local address, valid while the generation matches.
+  std::map<std::string, TargetListCache> list_cache_;
+  uint64_t list_generation_;
   FILE* out_;
   ServerState state_;
 
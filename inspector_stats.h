@@ -0,0 +1,112 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+#ifndef SRC_INSPECTOR_STATS_H_
+#define SRC_INSPECTOR_STATS_H_
+
+#include <atomic>
+#include <stdint.h>
+
+namespace inspector {
+
+typedef std::atomic<uint64_t> StatsCounter;
+
+// Counters shared by the IO thread and the main thread. Owned by InspectorIo
+// and served as JSON from /json/stats.
+struct InspectorStats {
+  // permessage-deflate, outgoing. Ratio is raw / compressed bytes.
+  StatsCounter deflate_messages{0};
+  StatsCounter deflate_raw_bytes{0};
+  StatsCounter deflate_compressed_bytes{0};
+  StatsCounter deflate_time_ns{0};
+  // permessage-deflate, incoming.
+  StatsCounter inflate_messages{0};
+  StatsCounter inflate_compressed_bytes{0};
+  StatsCounter inflate_raw_bytes{0};
+  StatsCounter inflate_time_ns{0};
+  // Socket writes. Frames per write is frames / writes.
+  StatsCounter socket_writes{0};
+  StatsCounter socket_write_frames{0};
+  StatsCounter socket_write_bytes{0};
+  // Binary CBOR messages from and to the frontend. The JSON size of the
+  // outgoing ones shows the bytes saved on the wire.
+  StatsCounter cbor_messages_in{0};
+  StatsCounter cbor_messages_out{0};
+  StatsCounter cbor_json_bytes_out{0};
+  StatsCounter cbor_bytes_out{0};
+  // Text messages from the frontend. ASCII ones need no transcoding,
+  // invalid UTF-8 fails the connection.
+  StatsCounter text_messages_in{0};
+  StatsCounter text_ascii_messages_in{0};
+  StatsCounter text_invalid_messages_in{0};
+  // /json/list, /json/version and /json/protocol replies, those answered
+  // with 304 Not Modified or sent compressed, and how often the target list
+  // had to be serialized again.
+  StatsCounter http_responses{0};
+  StatsCounter http_not_modified{0};
+  StatsCounter http_compressed_responses{0};
+  StatsCounter target_list_builds{0};
+  // Keepalive pings sent by the server, and the pongs that came back.
+  StatsCounter pings_sent{0};
+  StatsCounter pongs_received{0};
+  // Read buffers served from the pool, or allocated because it was empty.
+  StatsCounter read_pool_hits{0};
+  StatsCounter read_pool_misses{0};
+  // Write queue over the high watermark, and what was done about it.
+  StatsCounter backpressure_events{0};
+  StatsCounter backpressure_blocks{0};
+  StatsCounter backpressure_blocked_ns{0};
+  StatsCounter backpressure_dropped{0};
+  StatsCounter backpressure_disconnects{0};
+  // Shared memory transport: messages through the rings, and how often
+  // outgoing ones had to wait for the collector to make room. Read with
+  // InspectorIo::stats(), there is no /json/stats with this transport.
+  StatsCounter shm_messages_in{0};
+  StatsCounter shm_messages_out{0};
+  StatsCounter shm_bytes_out{0};
+  StatsCounter shm_ring_full{0};
+  // How the main thread was woken for incoming messages: an interrupt while
+  // it runs JavaScript, a platform task or the libuv loop while it is idle,
+  // the condition variable while it is paused in the debugger. The latency
+  // from a wakeup to the dispatch is summed over wakeup_dispatches.
+  StatsCounter wakeups_interrupt{0};
+  StatsCounter wakeups_task{0};
+  StatsCounter wakeups_uv_async{0};
+  StatsCounter wakeups_paused{0};
+  StatsCounter wakeup_dispatches{0};
+  StatsCounter wakeup_latency_ns{0};
+  // Incoming messages dispatched from the priority lane, for methods in
+  // InspectorOptions::priority_methods, and from the normal lane, with the
+  // time between the IO thread queueing them and dispatch summed per lane.
+  StatsCounter priority_messages{0};
+  StatsCounter priority_queue_delay_ns{0};
+  StatsCounter normal_messages{0};
+  StatsCounter normal_queue_delay_ns{0};
+};
+
+inline void StatsAdd(StatsCounter* counter, uint64_t value) {
+  counter->fetch_add(value, std::memory_order_relaxed);
+}
+
+}  // namespace inspector
+
+#endif  // SRC_INSPECTOR_STATS_H_
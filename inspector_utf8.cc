@@ -0,0 +1,381 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+
+
+#include "inspector_utf8.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define UTF8_VECTOR_WIDTH 32
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UTF8_VECTOR_WIDTH 16
+#else
+#define UTF8_VECTOR_WIDTH 0
+#endif
+
+namespace inspector {
+
+namespace {
+
+#if UTF8_VECTOR_WIDTH
+// Two vectors per step, ASCII iff no byte has its top bit set.
+const size_t kBlockSize = 2 * UTF8_VECTOR_WIDTH;
+
+bool IsAsciiBlock(const uint8_t* p) {
+#if UTF8_VECTOR_WIDTH == 32
+  __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+  return _mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0;
+#else
+  __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+  return _mm_movemask_epi8(_mm_or_si128(a, b)) == 0;
+#endif
+}
+
+// UTF-16 code units in the same two vectors.
+const size_t kUnitBlockSize = kBlockSize / 2;
+
+bool IsAsciiUnitBlock(const uint16_t* p) {
+#if UTF8_VECTOR_WIDTH == 32
+  __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 16));
+  __m256i high = _mm256_and_si256(_mm256_or_si256(a, b),
+                                  _mm256_set1_epi16(static_cast<short>(0xff80)));
+  return _mm256_testz_si256(high, high) != 0;
+#else
+  __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8));
+  __m128i high = _mm_and_si128(_mm_or_si128(a, b),
+                               _mm_set1_epi16(static_cast<short>(0xff80)));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128())) ==
+         0xffff;
+#endif
+}
+
+// Narrows an ASCII block of code units to bytes.
+void NarrowUnitBlock(const uint16_t* p, char* out) {
+#if UTF8_VECTOR_WIDTH == 32
+  __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 16));
+  // The pack works within 128-bit lanes, put the quarters back in order.
+  __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), bytes);
+#else
+  __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(a, b));
+#endif
+}
+
+// Zero extends an ASCII block to UTF-16.
+void WidenBlock(const uint8_t* p, uint16_t* out) {
+#if UTF8_VECTOR_WIDTH == 32
+  for (size_t i = 0; i < kBlockSize; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                        _mm256_cvtepu8_epi16(bytes));
+  }
+#else
+  const __m128i zero = _mm_setzero_si128();
+  for (size_t i = 0; i < kBlockSize; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                     _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8),
+                     _mm_unpackhi_epi8(bytes, zero));
+  }
+#endif
+}
+#else
+// Portable fallback: eight bytes at a time.
+const size_t kBlockSize = 16;
+
+bool IsAsciiBlock(const uint8_t* p) {
+  uint64_t a, b;
+  memcpy(&a, p, sizeof(a));
+  memcpy(&b, p + 8, sizeof(b));
+  return ((a | b) & 0x8080808080808080ull) == 0;
+}
+
+void WidenBlock(const uint8_t* p, uint16_t* out) {
+  for (size_t i = 0; i < kBlockSize; i++)
+    out[i] = p[i];
+}
+
+const size_t kUnitBlockSize = 8;
+
+bool IsAsciiUnitBlock(const uint16_t* p) {
+  uint64_t a, b;
+  memcpy(&a, p, sizeof(a));
+  memcpy(&b, p + 4, sizeof(b));
+  return ((a | b) & 0xff80ff80ff80ff80ull) == 0;
+}
+
+void NarrowUnitBlock(const uint16_t* p, char* out) {
+  for (size_t i = 0; i < kUnitBlockSize; i++)
+    out[i] = static_cast<char>(p[i]);
+}
+#endif
+
+bool IsContinuation(uint8_t c) {
+  return (c & 0xc0) == 0x80;
+}
+
+// Length of the multibyte sequence starting at p, 0 if it is malformed.
+// The allowed second bytes follow the table in RFC 3629, section 4.
+size_t SequenceLength(const uint8_t* p, const uint8_t* end) {
+  uint8_t lead = p[0];
+  size_t length;
+  uint8_t second_min = 0x80;
+  uint8_t second_max = 0xbf;
+  if (lead >= 0xc2 && lead <= 0xdf) {
+    length = 2;
+  } else if (lead >= 0xe0 && lead <= 0xef) {
+    length = 3;
+    if (lead == 0xe0)
+      second_min = 0xa0;  // Overlong
+    else if (lead == 0xed)
+      second_max = 0x9f;  // Surrogates
+  } else if (lead >= 0xf0 && lead <= 0xf4) {
+    length = 4;
+    if (lead == 0xf0)
+      second_min = 0x90;  // Overlong
+    else if (lead == 0xf4)
+      second_max = 0x8f;  // Past U+10FFFF
+  } else {
+    return 0;
+  }
+  if (static_cast<size_t>(end - p) < length ||
+      p[1] < second_min || p[1] > second_max) {
+    return 0;
+  }
+  for (size_t i = 2; i < length; i++) {
+    if (!IsContinuation(p[i]))
+      return 0;
+  }
+  return length;
+}
+
+bool IsHighSurrogate(uint16_t c) {
+  return (c & 0xfc00) == 0xd800;
+}
+
+bool IsLowSurrogate(uint16_t c) {
+  return (c & 0xfc00) == 0xdc00;
+}
+
+// Code point of a sequence SequenceLength() accepted.
+uint32_t DecodeSequence(const uint8_t* p, size_t length) {
+  static const uint8_t kLeadMask[] = {0, 0, 0x1f, 0x0f, 0x07};
+  uint32_t code_point = p[0] & kLeadMask[length];
+  for (size_t i = 1; i < length; i++)
+    code_point = (code_point << 6) | (p[i] & 0x3f);
+  return code_point;
+}
+
+}  // namespace
+
+Utf8Kind ClassifyUtf8(const char* data, size_t length) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+  const uint8_t* end = p + length;
+  bool ascii = true;
+  while (p < end) {
+    while (static_cast<size_t>(end - p) >= kBlockSize && IsAsciiBlock(p))
+      p += kBlockSize;
+    // Byte by byte through the block that stopped the vector loop, then back
+    // to whole blocks. Sequences may run a few bytes past it.
+    const uint8_t* block_end =
+        static_cast<size_t>(end - p) > kBlockSize ? p + kBlockSize : end;
+    while (p < block_end) {
+      if (*p < 0x80) {
+        p++;
+        continue;
+      }
+      size_t sequence = SequenceLength(p, end);
+      if (sequence == 0)
+        return Utf8Kind::kInvalid;
+      ascii = false;
+      p += sequence;
+    }
+  }
+  return ascii ? Utf8Kind::kAscii : Utf8Kind::kUtf8;
+}
+
+// Same walk as ClassifyUtf8, writing as it goes. Every sequence yields at
+// most as many code units as it has bytes.
+size_t Utf8ToUtf16(const char* data, size_t length, uint16_t* out) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+  const uint8_t* end = p + length;
+  uint16_t* q = out;
+  while (p < end) {
+    while (static_cast<size_t>(end - p) >= kBlockSize && IsAsciiBlock(p)) {
+      WidenBlock(p, q);
+      p += kBlockSize;
+      q += kBlockSize;
+    }
+    const uint8_t* block_end =
+        static_cast<size_t>(end - p) > kBlockSize ? p + kBlockSize : end;
+    while (p < block_end) {
+      if (*p < 0x80) {
+        *q++ = *p++;
+        continue;
+      }
+      size_t sequence = SequenceLength(p, end);
+      if (sequence == 0) {
+        *q++ = 0xfffd;
+        p++;
+        continue;
+      }
+      uint32_t code_point = DecodeSequence(p, sequence);
+      if (code_point >= 0x10000) {
+        code_point -= 0x10000;
+        *q++ = static_cast<uint16_t>(0xd800 | (code_point >> 10));
+        *q++ = static_cast<uint16_t>(0xdc00 | (code_point & 0x3ff));
+      } else {
+        *q++ = static_cast<uint16_t>(code_point);
+      }
+      p += sequence;
+    }
+  }
+  return q - out;
+}
+
+size_t Utf16ToUtf8Length(const uint16_t* data, size_t length) {
+  const uint16_t* p = data;
+  const uint16_t* end = p + length;
+  size_t utf8_length = 0;
+  while (p < end) {
+    while (static_cast<size_t>(end - p) >= kUnitBlockSize &&
+           IsAsciiUnitBlock(p)) {
+      p += kUnitBlockSize;
+      utf8_length += kUnitBlockSize;
+    }
+    const uint16_t* block_end =
+        static_cast<size_t>(end - p) > kUnitBlockSize ? p + kUnitBlockSize
+                                                      : end;
+    while (p < block_end) {
+      uint16_t c = *p++;
+      if (c < 0x80) {
+        utf8_length += 1;
+      } else if (c < 0x800) {
+        utf8_length += 2;
+      } else if (IsHighSurrogate(c) && p < end && IsLowSurrogate(*p)) {
+        p++;
+        utf8_length += 4;
+      } else {
+        utf8_length += 3;  // Lone surrogates included, as U+FFFD
+      }
+    }
+  }
+  return utf8_length;
+}
+
+size_t Utf16ToUtf8(const uint16_t* data, size_t length, char* out) {
+  const uint16_t* p = data;
+  const uint16_t* end = p + length;
+  uint8_t* q = reinterpret_cast<uint8_t*>(out);
+  while (p < end) {
+    while (static_cast<size_t>(end - p) >= kUnitBlockSize &&
+           IsAsciiUnitBlock(p)) {
+      NarrowUnitBlock(p, reinterpret_cast<char*>(q));
+      p += kUnitBlockSize;
+      q += kUnitBlockSize;
+    }
+    const uint16_t* block_end =
+        static_cast<size_t>(end - p) > kUnitBlockSize ? p + kUnitBlockSize
+                                                      : end;
+    while (p < block_end) {
+      uint32_t c = *p++;
+      if (c < 0x80) {
+        *q++ = static_cast<uint8_t>(c);
+        continue;
+      }
+      if (c < 0x800) {
+        *q++ = static_cast<uint8_t>(0xc0 | (c >> 6));
+        *q++ = static_cast<uint8_t>(0x80 | (c & 0x3f));
+        continue;
+      }
+      if (IsHighSurrogate(c) && p < end && IsLowSurrogate(*p)) {
+        c = 0x10000 + ((c - 0xd800) << 10) + (*p++ - 0xdc00);
+        *q++ = static_cast<uint8_t>(0xf0 | (c >> 18));
+        *q++ = static_cast<uint8_t>(0x80 | ((c >> 12) & 0x3f));
+        *q++ = static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3f));
+        *q++ = static_cast<uint8_t>(0x80 | (c & 0x3f));
+        continue;
+      }
+      if ((c & 0xf800) == 0xd800)
+        c = 0xfffd;
+      *q++ = static_cast<uint8_t>(0xe0 | (c >> 12));
+      *q++ = static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3f));
+      *q++ = static_cast<uint8_t>(0x80 | (c & 0x3f));
+    }
+  }
+  return reinterpret_cast<char*>(q) - out;
+}
+
+size_t Latin1ToUtf8Length(const uint8_t* data, size_t length) {
+  const uint8_t* p = data;
+  const uint8_t* end = p + length;
+  size_t utf8_length = length;
+  while (p < end) {
+    while (static_cast<size_t>(end - p) >= kBlockSize && IsAsciiBlock(p))
+      p += kBlockSize;
+    const uint8_t* block_end =
+        static_cast<size_t>(end - p) > kBlockSize ? p + kBlockSize : end;
+    for (; p < block_end; p++)
+      utf8_length += *p >> 7;
+  }
+  return utf8_length;
+}
+
+size_t Latin1ToUtf8(const uint8_t* data, size_t length, char* out) {
+  const uint8_t* p = data;
+  const uint8_t* end = p + length;
+  uint8_t* q = reinterpret_cast<uint8_t*>(out);
+  while (p < end) {
+    while (static_cast<size_t>(end - p) >= kBlockSize && IsAsciiBlock(p)) {
+      memcpy(q, p, kBlockSize);
+      p += kBlockSize;
+      q += kBlockSize;
+    }
+    const uint8_t* block_end =
+        static_cast<size_t>(end - p) > kBlockSize ? p + kBlockSize : end;
+    for (; p < block_end; p++) {
+      if (*p < 0x80) {
+        *q++ = *p;
+      } else {
+        *q++ = static_cast<uint8_t>(0xc0 | (*p >> 6));
+        *q++ = static_cast<uint8_t>(0x80 | (*p & 0x3f));
+      }
+    }
+  }
+  return reinterpret_cast<char*>(q) - out;
+}
+
+}  // namespace inspector
@@ -0,0 +1,58 @@
+/*
+*    Copyright Node.js contributors. All rights reserved.
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to
+*    deal in the Software without restriction, including without limitation the
+*    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+*    sell copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*    IN THE SOFTWARE.
+*/
+
+
+
+#ifndef SRC_INSPECTOR_UTF8_H_
+#define SRC_INSPECTOR_UTF8_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace inspector {
+
+enum class Utf8Kind { kInvalid, kAscii, kUtf8 };
+
+// Validates text against RFC 3629 (no overlong forms, surrogates or code
+// points past U+10FFFF) and tells plain 7-bit ASCII apart in the same
+// pass, so transcoding later can skip its own scan. ASCII runs are checked
+// a vector at a time.
+Utf8Kind ClassifyUtf8(const char* data, size_t length);
+
+// Converts UTF-8 to UTF-16 without ICU, ASCII runs a vector at a time. out
+// must have room for length code units, which is the most it can take.
+// Malformed bytes are replaced by U+FFFD one at a time. Returns the number
+// of code units written.
+size_t Utf8ToUtf16(const char* data, size_t length, uint16_t* out);
+
+// The other way, for what V8 sends: UTF-16, where unpaired surrogates
+// become U+FFFD, or Latin-1. The length functions return exactly what the
+// conversions write, so the output can be sized once up front. Both passes
+// take ASCII runs a vector at a time.
+size_t Utf16ToUtf8Length(const uint16_t* data, size_t length);
+size_t Utf16ToUtf8(const uint16_t* data, size_t length, char* out);
+size_t Latin1ToUtf8Length(const uint8_t* data, size_t length);
+size_t Latin1ToUtf8(const uint8_t* data, size_t length, char* out);
+
+}  // namespace inspector
+
+#endif  // SRC_INSPECTOR_UTF8_H_
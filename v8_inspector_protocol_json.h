@@ -0,0 +1,492 @@
+0,205,72,62,103,175,10,120,218,237,125,107,111,220,58,146,232,95,17,140,
+5,226,0,142,103,118,47,176,247,98,118,177,64,142,227,204,241,34,137,13,
+59,153,185,192,34,31,212,18,219,205,99,181,212,87,148,236,244,14,242,223,
+111,189,72,145,18,245,104,219,201,100,206,6,216,157,19,171,249,40,146,197,
+122,87,241,111,71,247,170,54,186,42,143,254,244,183,163,109,250,91,85,31,
+253,233,232,159,143,78,142,182,186,164,127,255,203,209,215,147,163,188,218,166,
+186,52,71,127,250,175,191,201,191,225,151,155,108,163,182,41,52,205,149,201,
+106,189,107,104,148,163,171,186,186,215,240,41,209,229,186,170,183,41,126,78,
+210,85,213,54,73,179,81,201,174,174,154,42,171,138,196,80,247,83,232,223,
+236,119,138,199,214,57,12,240,134,39,224,239,240,119,181,250,77,101,205,96,
+158,55,221,95,73,181,14,199,102,24,113,108,248,180,83,117,163,101,130,50,
+221,226,144,244,31,55,129,105,106,93,222,14,39,160,65,18,108,123,10,155,
+224,58,219,13,91,216,95,154,195,16,159,191,126,62,57,202,170,237,54,45,
+243,0,156,91,213,188,145,29,238,15,114,173,154,182,46,77,98,218,221,174,
+170,27,149,203,218,12,46,110,3,3,21,48,60,140,117,180,170,171,7,163,
+106,248,90,171,50,87,53,252,243,51,254,155,186,251,147,229,110,38,1,63,
+173,235,116,15,127,234,70,109,13,162,193,63,213,106,221,157,195,215,62,72,
+239,180,105,112,199,35,32,225,18,113,167,28,142,92,183,101,163,105,175,123,
+203,226,239,210,51,81,95,118,149,1,148,249,207,244,62,189,161,102,73,45,
+45,86,251,100,171,82,216,1,152,177,86,219,170,81,137,186,79,139,86,240,
+170,204,147,173,174,235,170,78,24,77,204,105,114,222,253,92,43,211,22,141,
+73,210,90,37,188,21,0,109,106,194,46,128,58,105,35,32,184,79,176,53,
+39,9,31,44,244,220,193,64,170,108,186,57,219,82,255,191,86,37,128,231,
+0,229,90,171,154,7,201,210,50,89,169,164,53,48,13,32,127,178,110,107,
+192,75,55,17,236,43,28,76,153,169,211,228,178,214,183,186,76,11,11,54,
+129,136,123,209,192,255,67,111,216,148,45,172,182,222,195,84,133,50,6,241,
+123,79,141,148,166,33,1,222,66,103,186,41,246,48,108,161,82,156,18,102,
+228,149,202,223,105,81,1,248,15,208,129,174,71,229,193,130,215,19,63,106,
+7,220,109,93,181,187,200,117,228,243,184,200,103,241,253,19,239,9,127,242,
+182,134,47,15,141,117,77,7,120,73,19,46,31,81,0,140,142,248,169,4,
+164,215,105,161,255,59,93,21,234,47,112,242,177,139,173,202,118,139,151,228,
+162,92,235,82,55,136,237,31,210,15,240,191,175,188,47,175,254,136,55,166,
+79,204,244,86,55,250,94,37,136,84,42,121,216,232,108,131,199,92,86,13,
+158,244,127,222,92,126,120,197,211,32,100,249,200,90,103,137,217,251,0,33,
+45,158,32,242,85,22,81,188,187,193,205,198,201,27,205,53,190,11,14,134,
+117,91,102,13,147,178,22,104,198,26,49,15,254,237,58,64,251,21,145,148,
+85,85,1,74,97,59,179,223,174,170,98,184,81,151,221,189,9,136,165,105,
+87,35,208,84,212,53,45,142,254,212,212,173,234,160,179,228,168,108,139,2,
+255,83,229,138,136,218,45,96,60,238,91,218,224,223,219,20,255,48,10,151,
+241,160,210,59,254,27,255,197,223,128,152,213,105,83,33,240,183,170,116,255,
+86,184,205,188,111,95,246,252,223,173,54,22,188,156,231,30,91,156,172,37,
+217,192,45,61,77,110,118,42,163,51,167,155,254,239,25,192,249,31,188,179,
+255,254,7,250,131,54,131,241,6,168,87,89,236,131,141,201,138,212,152,15,
+113,62,212,223,154,40,52,52,64,114,156,85,37,244,107,51,88,223,75,230,
+85,79,133,236,62,188,68,105,185,159,5,137,113,221,162,47,95,21,160,47,
+89,138,20,117,13,124,57,184,69,6,9,21,222,28,251,231,177,94,39,186,
+73,30,128,50,215,10,110,188,1,166,242,50,128,169,141,94,115,97,84,113,
+26,48,13,241,232,197,78,70,110,54,176,42,128,20,127,220,164,208,139,119,
+149,250,202,166,158,36,43,16,113,128,149,35,173,214,38,145,171,25,238,173,
+15,196,161,231,126,19,229,70,34,250,88,146,224,205,85,117,100,86,54,106,
+64,126,167,39,28,35,191,201,49,226,85,89,149,175,250,7,27,30,26,192,
+121,175,213,67,55,63,207,124,229,62,207,29,17,181,75,0,195,145,41,226,
+218,211,213,10,63,166,40,116,216,253,149,169,31,135,246,64,17,190,192,40,
+32,104,192,28,2,135,127,73,91,211,84,219,171,254,58,206,122,159,7,164,
+108,56,230,103,199,23,250,157,251,140,97,216,121,140,204,111,84,154,19,121,
+14,241,200,131,127,147,154,95,170,124,223,53,177,132,220,107,195,66,58,144,
+203,203,57,124,241,58,173,116,153,251,191,190,21,78,178,172,55,156,232,90,
+223,94,30,138,159,222,38,246,49,105,201,38,198,169,104,28,185,234,33,65,
+251,201,110,31,203,110,191,11,63,253,174,148,21,116,186,117,81,61,12,239,
+85,127,228,143,53,114,194,53,40,75,213,86,121,106,170,96,17,50,66,152,
+175,166,127,202,116,161,98,144,228,58,39,174,179,214,77,143,184,58,84,156,
+213,228,174,132,84,218,251,50,170,210,133,208,5,243,9,152,243,147,157,67,
+67,127,166,233,173,247,103,150,41,226,168,0,24,103,241,0,21,48,254,8,
+200,103,63,90,100,10,241,163,163,24,253,61,120,10,225,93,100,62,176,19,
+14,13,8,223,158,94,156,28,165,89,6,90,227,196,229,35,210,145,188,150,
+102,162,99,147,18,235,33,193,30,196,50,163,10,144,206,64,65,5,205,215,
+182,142,202,54,247,35,202,215,140,144,1,178,219,171,53,156,123,153,131,42,
+27,50,117,81,192,135,179,92,61,77,178,248,64,18,166,204,33,82,202,255,
+104,50,218,93,147,224,246,62,229,142,220,169,253,83,5,63,33,11,48,82,
+127,89,176,111,175,10,125,167,128,125,23,133,162,75,226,168,71,12,37,71,
+192,152,156,86,152,126,132,132,88,203,99,85,207,234,245,114,68,14,173,115,
+215,245,137,198,201,128,186,32,27,225,155,159,120,173,166,118,162,103,156,152,
+62,143,143,118,55,18,208,56,171,140,37,36,103,85,138,210,130,135,90,55,
+168,140,197,56,228,204,100,204,49,187,35,152,156,20,48,97,143,218,90,182,
+73,203,91,104,112,12,23,45,245,118,153,49,60,84,75,110,233,170,61,102,
+35,94,39,150,36,139,190,8,180,235,30,110,17,232,173,41,106,126,112,123,
+9,61,125,8,79,18,119,13,29,17,183,55,145,151,89,43,36,175,101,101,
+71,56,118,100,118,122,29,230,219,172,195,60,121,29,230,176,117,176,54,208,
+214,99,248,50,142,31,68,201,232,186,122,250,182,55,91,31,59,80,112,208,
+235,40,2,229,170,80,136,97,235,186,218,82,131,172,170,65,24,220,85,101,
+78,86,184,161,16,136,148,95,29,12,180,15,168,217,84,15,38,105,119,73,
+222,146,252,41,35,246,60,26,78,84,44,151,193,245,144,154,143,155,186,122,
+40,159,118,247,216,116,78,54,153,134,134,179,80,146,164,230,76,236,193,212,
+218,92,62,196,102,57,224,72,59,193,3,86,252,80,10,189,31,145,195,157,
+180,243,152,75,224,40,168,80,78,30,255,36,10,8,127,18,153,147,154,251,
+204,52,96,18,23,37,224,62,76,250,120,102,161,101,132,40,215,72,62,6,
+40,164,77,249,162,129,59,7,42,124,1,226,211,189,54,26,16,18,109,111,
+158,185,24,33,125,34,187,57,171,202,123,52,255,84,1,92,67,215,216,247,
+224,50,158,41,5,22,253,186,190,109,81,30,153,221,221,107,171,221,153,142,
+250,101,48,64,146,202,8,167,201,57,187,86,66,229,95,231,129,20,117,145,
+59,123,95,103,253,138,89,3,67,147,101,223,6,138,212,180,20,87,14,160,
+23,89,212,28,93,125,137,75,222,34,125,104,139,28,169,147,177,210,207,248,
+49,62,194,106,219,179,129,254,96,6,215,231,181,101,134,22,106,118,156,134,
+130,239,23,149,181,216,24,80,189,81,95,2,247,20,222,200,91,210,180,194,
+65,47,114,60,187,20,253,151,210,153,236,73,208,219,243,3,245,7,126,19,
+51,84,44,243,113,195,76,218,84,5,223,140,170,46,38,208,65,123,91,21,
+93,90,212,212,171,115,167,139,15,86,148,92,132,254,205,166,18,180,220,35,
+185,225,227,28,244,178,222,64,207,101,219,97,53,128,141,198,199,254,81,147,
+1,100,150,34,157,15,166,226,142,193,88,139,104,219,175,237,54,69,87,113,
+154,211,69,37,129,154,91,172,144,223,221,2,206,246,206,85,70,79,219,47,
+111,64,220,140,156,226,52,46,158,131,218,158,231,160,246,202,181,206,18,24,
+73,23,58,173,129,212,195,128,61,188,204,20,117,124,163,154,84,23,102,1,
+206,96,59,114,33,247,227,47,148,29,43,57,70,195,19,106,149,47,89,231,
+31,178,121,99,121,199,118,167,11,145,73,234,238,128,199,49,207,77,178,228,
+6,185,213,1,234,133,54,18,216,236,5,56,96,123,99,243,19,43,204,58,
+4,19,60,5,185,26,201,44,241,146,110,11,132,20,60,108,224,116,129,87,
+194,34,87,69,72,3,11,160,197,31,172,141,101,102,33,239,160,109,194,6,
+153,238,10,217,169,138,42,227,29,60,254,227,171,21,122,230,251,2,112,209,
+110,203,165,51,157,81,235,199,206,101,58,111,190,80,7,207,191,63,99,37,
+101,140,184,120,51,62,105,200,66,234,226,112,107,208,245,187,241,209,79,144,
+230,216,99,165,115,195,118,130,168,136,193,200,73,106,197,65,41,225,170,155,
+52,187,251,88,167,153,199,196,110,252,111,211,80,121,178,20,141,148,52,216,
+13,37,197,56,226,56,208,31,41,10,157,247,145,116,98,166,8,105,159,34,
+251,211,19,95,116,62,62,57,5,75,92,31,72,191,235,206,100,147,238,118,
+170,164,109,238,104,213,71,189,85,176,65,219,93,119,238,206,70,217,179,192,
+57,236,221,234,162,208,70,193,60,185,73,140,46,97,95,225,4,179,141,199,
+65,81,204,123,91,7,164,124,132,246,209,153,146,37,104,79,122,131,13,34,
+34,82,103,72,255,3,225,18,105,86,197,17,84,113,18,102,229,195,15,75,
+216,135,135,28,78,174,28,8,198,147,215,110,28,217,108,40,205,130,123,53,
+55,136,181,19,65,239,71,19,185,225,168,133,71,246,158,131,184,13,103,200,
+2,114,231,207,209,225,93,112,149,167,49,4,113,9,148,124,128,205,16,134,
+116,232,144,88,150,152,192,111,38,189,85,19,8,242,12,206,38,184,203,170,
+112,198,11,143,172,156,38,111,9,174,125,153,241,7,137,39,16,67,69,42,
+39,201,215,211,97,28,113,113,140,100,98,189,9,127,227,33,80,197,9,15,
+196,222,166,5,190,156,238,230,125,125,20,218,239,210,154,85,179,195,105,238,
+107,132,30,36,146,178,106,131,184,64,159,0,211,162,65,171,203,84,78,107,
+182,27,121,50,78,48,37,224,231,12,196,61,156,200,146,149,193,122,151,56,
+245,7,184,37,131,50,126,217,35,186,226,25,69,56,129,249,243,54,147,19,
+42,73,66,246,214,201,203,34,214,6,186,106,85,220,171,124,176,150,209,40,
+82,145,177,17,118,216,119,248,214,112,104,168,199,44,80,3,94,20,187,122,
+238,154,34,207,181,35,71,84,178,63,99,212,224,225,119,128,108,40,32,248,
+82,208,33,99,244,32,128,18,38,150,72,198,100,219,22,141,222,21,202,5,
+121,6,86,167,50,43,218,92,157,241,150,160,32,246,250,234,226,112,227,215,
+27,220,175,45,244,54,120,0,36,49,202,144,9,9,119,48,168,39,90,186,
+19,89,96,22,51,32,142,251,6,138,165,16,93,128,178,68,93,147,109,149,
+123,204,183,47,170,251,241,176,192,164,125,41,136,88,94,94,209,183,93,10,
+219,234,73,240,201,229,61,208,59,10,213,118,222,212,43,108,115,89,58,1,
+196,121,87,155,254,241,103,207,34,112,88,183,142,153,210,33,1,17,68,85,
+244,119,56,185,16,67,157,197,117,178,212,109,117,99,233,159,183,45,15,32,
+100,4,26,167,68,191,118,186,35,143,165,75,84,201,40,186,8,24,64,176,
+94,14,31,254,101,223,11,49,93,122,150,127,21,148,242,76,171,0,46,210,
+20,154,142,5,219,148,163,226,252,176,100,207,6,132,136,176,218,71,108,53,
+226,42,84,3,183,221,56,112,243,196,204,2,44,238,81,15,16,59,93,103,
+154,229,5,133,66,10,176,213,63,131,48,216,214,234,121,225,233,208,163,131,
+168,65,194,203,145,221,29,11,132,173,66,32,236,73,127,186,8,117,247,135,
+84,55,87,65,244,231,35,78,115,0,12,142,74,219,34,124,70,14,214,18,
+115,135,180,130,2,128,118,30,150,106,214,96,82,203,50,128,244,55,47,12,
+226,168,209,24,209,239,208,164,100,65,5,153,65,52,196,159,71,31,85,62,
+122,164,190,31,46,31,87,101,58,243,131,187,237,131,95,150,106,53,57,247,
+96,248,163,208,40,186,27,150,5,193,255,221,22,213,202,5,197,76,157,100,
+156,245,201,113,44,8,57,155,83,136,100,164,223,49,109,120,6,58,240,12,
+104,105,197,38,25,51,249,43,146,112,137,214,131,143,191,241,222,72,168,241,
+218,221,55,142,33,230,95,191,27,34,35,0,44,151,26,177,12,152,80,100,
+27,8,183,121,46,54,232,154,184,155,5,30,45,84,108,111,180,159,156,19,
+98,40,195,139,212,125,89,142,98,125,245,116,116,183,248,86,177,175,196,137,
+250,61,17,199,126,127,163,178,34,101,23,230,124,126,84,215,118,168,206,84,
+67,197,197,250,105,22,234,45,158,99,40,162,2,58,167,207,124,136,90,208,
+222,156,38,175,17,17,131,111,32,159,26,244,97,80,186,13,128,78,102,41,
+148,105,61,189,133,236,245,9,153,89,129,43,64,87,213,68,93,154,191,71,
+89,241,251,211,199,190,37,248,167,240,244,83,120,250,22,194,19,209,134,31,
+64,108,66,56,60,191,182,199,72,114,159,202,242,105,242,15,66,124,146,75,
+47,253,207,210,225,238,150,233,18,142,74,7,145,49,227,196,11,62,95,249,
+97,201,223,129,43,241,1,250,113,50,235,170,14,237,20,15,101,0,212,129,
+193,41,136,115,216,78,102,50,254,84,76,241,41,14,167,44,246,150,242,171,
+66,225,93,148,208,217,19,66,75,248,9,254,228,4,101,138,90,202,54,105,
+207,87,105,163,165,58,96,47,97,208,103,0,184,31,181,139,144,31,51,134,
+80,160,214,31,56,94,235,37,45,226,223,6,225,39,216,188,99,21,146,67,
+203,145,11,179,249,51,63,8,113,53,243,151,125,97,4,189,23,205,243,117,
+58,214,179,31,138,170,195,184,160,73,92,28,131,98,34,182,232,235,80,32,
+144,99,172,250,96,37,199,132,173,214,205,22,96,235,203,191,43,21,187,30,
+94,49,140,122,248,118,4,75,236,139,142,184,127,23,130,69,83,198,151,79,
+63,153,94,0,146,71,204,123,106,64,0,190,181,196,78,173,97,204,90,59,
+98,157,245,51,195,173,113,127,28,106,102,133,30,228,146,79,208,201,197,246,
+36,37,213,220,95,73,91,94,172,255,10,252,31,224,121,91,213,111,212,170,
+189,141,249,135,62,42,228,115,157,153,14,254,213,164,232,51,196,157,109,203,
+164,75,36,125,224,193,136,18,228,50,28,193,208,128,162,182,233,69,114,74,
+20,103,15,101,233,179,17,249,152,168,252,122,104,157,4,17,195,154,253,253,
+82,5,44,37,247,221,179,103,44,107,89,73,89,221,83,216,217,95,173,43,
+187,155,137,210,72,25,46,107,204,196,75,106,237,152,36,206,234,237,86,229,
+40,174,21,236,236,84,41,89,79,181,161,17,70,66,146,172,3,75,155,232,
+154,223,240,247,229,139,238,143,154,165,117,14,139,5,137,77,157,187,140,161,
+193,28,216,202,216,224,125,100,39,157,186,130,74,72,198,3,144,201,29,53,
+45,211,143,123,230,28,74,73,61,180,249,139,124,94,249,184,251,195,253,222,
+79,134,252,60,151,6,74,65,48,138,53,185,231,119,175,200,240,225,34,171,
+182,206,212,167,235,119,243,183,149,90,162,95,87,36,92,216,31,199,255,184,
+97,232,1,195,122,36,166,113,139,153,17,39,58,11,253,131,167,134,9,200,
+185,245,210,6,65,93,56,252,192,250,242,172,113,10,135,186,13,140,171,41,
+242,125,220,6,113,97,227,9,177,55,23,46,48,47,114,162,223,93,217,224,
+195,247,77,180,125,98,62,115,85,14,8,135,232,175,92,40,253,255,100,236,
+250,1,125,176,191,75,179,213,15,239,88,254,157,217,213,158,213,134,246,211,
+70,229,213,218,250,17,76,84,0,134,113,193,154,190,74,131,100,47,29,132,
+89,163,76,118,79,214,254,64,196,138,202,211,163,124,70,134,27,231,6,97,
+48,126,63,75,174,84,15,32,91,103,98,32,237,243,128,216,34,47,140,105,
+109,112,42,244,142,240,13,109,236,128,147,44,12,0,107,234,106,63,37,206,
+30,202,244,198,248,106,110,167,178,48,206,172,43,186,38,55,200,228,170,204,
+25,220,190,90,69,160,241,198,71,61,114,208,49,121,192,248,211,140,187,35,
+198,216,122,119,49,140,118,249,111,83,139,176,40,235,133,190,115,101,55,118,
+204,113,110,69,116,231,27,47,204,85,54,220,143,124,237,105,172,246,151,65,
+92,243,99,111,35,7,62,246,251,93,171,251,234,110,102,103,221,218,122,203,
+175,185,239,248,138,1,97,205,2,181,230,154,154,249,201,19,15,155,253,216,
+92,177,69,44,73,25,192,60,49,206,83,145,161,186,9,78,146,212,116,114,
+1,32,137,213,194,229,247,79,118,253,194,243,79,195,189,20,181,19,248,49,
+154,211,103,246,210,215,81,113,93,25,117,153,64,154,233,162,15,69,197,219,
+185,106,241,191,152,186,225,85,43,123,72,235,82,246,91,215,252,191,95,182,
+20,4,108,211,79,37,164,146,238,7,149,136,72,107,39,22,118,127,156,129,
+194,157,238,12,173,76,149,185,109,192,49,176,28,236,186,214,52,160,252,235,
+188,196,166,89,213,178,108,7,168,140,95,6,212,225,163,203,195,85,81,183,
+237,2,143,109,192,193,190,206,184,96,159,36,251,31,22,241,110,151,68,103,
+188,77,243,94,37,143,67,40,1,45,194,245,120,206,252,132,27,47,38,54,
+75,119,232,55,244,18,36,250,224,127,14,68,92,210,45,174,109,213,181,73,
+148,23,25,176,19,196,58,205,132,242,23,213,23,88,87,161,78,56,143,188,
+147,128,164,217,241,203,68,194,86,57,108,220,90,119,94,158,206,88,45,71,
+228,28,191,206,149,14,194,2,164,219,160,26,233,168,89,209,254,48,81,143,
+148,109,136,72,211,96,135,211,149,46,52,153,248,49,43,14,214,128,137,220,
+232,70,161,58,82,37,215,143,186,199,63,86,64,58,239,118,21,194,135,245,
+68,213,110,199,50,61,92,189,91,79,173,60,161,122,158,21,103,94,117,167,
+9,125,84,147,157,18,188,59,44,235,90,102,28,137,238,10,171,126,30,212,
+235,252,197,205,184,160,194,102,215,56,94,94,211,5,68,47,24,171,11,173,
+143,143,245,78,210,120,34,49,250,241,40,251,161,149,64,86,125,58,106,45,
+184,233,23,31,237,115,132,46,143,219,158,249,41,247,191,74,107,227,51,134,
+167,167,129,233,32,63,233,113,217,17,51,145,41,65,110,196,248,124,3,130,
+109,143,194,245,97,27,34,39,138,119,105,21,188,49,149,209,114,108,49,223,
+220,178,163,156,218,195,197,219,241,216,117,76,229,15,197,193,205,2,180,239,
+39,7,68,240,46,142,251,156,172,239,33,163,230,250,23,168,46,107,36,170,
+192,98,185,208,137,174,155,54,45,128,66,103,27,196,32,76,241,71,51,69,
+30,13,178,90,148,150,244,193,75,65,136,229,106,176,188,194,33,1,218,72,
+116,87,221,79,224,176,205,189,187,43,187,225,125,57,220,133,59,123,110,22,
+109,166,166,125,220,144,38,131,3,63,219,4,21,198,199,132,146,27,108,59,
+148,70,232,51,123,240,197,2,49,190,129,248,219,144,126,77,234,235,76,158,
+176,163,53,77,9,227,157,155,139,13,5,189,92,253,145,41,151,214,98,88,
+41,174,140,199,126,127,87,29,195,161,17,70,58,54,46,10,3,25,73,140,
+222,248,197,40,58,216,147,215,184,239,136,164,89,152,149,181,237,228,22,98,
+134,1,77,170,118,203,239,241,140,208,205,65,197,240,1,241,12,255,139,118,
+9,18,163,43,195,177,87,128,83,25,126,89,65,139,59,148,165,173,93,27,
+173,58,88,208,171,202,219,66,13,37,98,70,145,65,121,198,129,60,179,4,
+31,46,109,81,104,169,95,97,141,130,132,201,156,45,198,40,195,203,25,86,
+201,195,85,57,43,39,118,50,232,36,173,187,122,24,148,45,150,17,5,98,
+8,255,205,183,172,53,157,1,30,251,162,209,138,142,189,70,162,150,105,232,
+4,178,74,105,52,154,2,5,83,93,37,27,74,36,175,168,222,88,173,217,
+179,136,113,102,141,25,11,147,40,151,84,68,14,37,231,186,57,136,58,45,
+38,27,162,1,48,252,52,143,9,189,198,249,119,152,87,97,146,215,215,17,
+252,26,20,251,226,43,2,58,96,182,121,47,152,59,147,48,75,109,129,239,
+64,99,206,152,85,12,201,233,65,172,124,36,203,183,39,13,217,177,89,197,
+42,155,129,148,117,198,223,103,121,27,141,75,54,68,6,188,27,111,212,147,
+219,137,198,63,197,208,191,151,24,186,184,2,166,141,215,184,65,151,140,196,
+112,35,55,56,178,198,112,36,184,253,218,192,241,178,203,35,169,146,211,17,
+31,46,94,196,82,65,137,201,71,247,91,114,86,104,34,154,162,6,147,65,
+31,148,100,235,61,99,139,170,213,21,55,41,70,9,162,189,81,98,57,16,
+115,10,223,67,208,49,117,209,141,53,98,74,166,244,125,79,250,155,13,217,
+8,160,246,32,238,197,78,116,42,159,121,157,97,65,158,81,237,59,181,63,
+207,132,8,124,80,15,34,45,224,204,158,198,155,240,8,206,181,54,204,131,
+192,223,41,219,231,15,0,126,234,254,66,206,239,143,35,129,171,177,229,220,
+220,233,221,235,162,32,175,222,120,204,169,129,86,135,46,4,251,176,24,110,
+198,87,240,62,189,83,134,0,35,76,160,40,191,186,197,55,26,208,156,188,
+183,253,143,187,213,156,248,246,202,188,218,122,246,81,208,245,95,142,31,215,
+47,251,79,148,249,31,95,225,99,201,67,67,245,250,188,221,6,121,238,57,
+203,120,88,162,111,34,51,13,11,134,92,99,193,212,131,167,163,94,176,213,
+24,5,84,186,75,11,64,152,5,80,32,118,185,210,95,82,224,176,118,82,
+84,229,125,163,105,236,15,146,242,225,151,230,122,54,130,122,185,94,35,140,
+66,73,201,88,54,123,76,88,64,67,63,170,32,65,24,140,132,14,116,178,
+223,121,83,185,177,37,86,205,173,249,164,35,58,20,205,64,202,173,105,170,
+157,189,177,222,32,182,252,161,151,215,167,92,178,31,134,78,215,237,120,232,
+204,42,52,106,9,31,238,153,186,198,28,92,214,129,231,1,227,63,206,211,
+189,202,19,83,61,23,216,174,157,68,49,89,87,219,13,200,219,224,1,99,
+157,199,72,61,224,0,118,72,58,114,217,240,152,236,135,177,129,158,70,21,
+224,132,16,126,87,5,200,29,149,125,55,104,181,79,232,118,214,244,31,42,
+80,124,154,92,82,8,101,143,11,105,50,253,158,136,63,78,194,10,119,36,
+159,8,119,55,124,234,244,32,134,127,161,220,130,216,20,42,49,227,206,31,
+227,118,194,222,37,87,220,47,121,43,103,66,114,157,87,134,10,167,37,127,
+146,118,249,22,56,158,105,87,6,77,215,176,116,30,186,131,226,90,96,8,
+98,45,237,162,196,50,83,84,183,26,228,10,127,7,105,2,80,254,238,145,
+111,17,89,175,85,81,165,185,25,167,203,227,36,249,17,214,139,225,61,239,
+165,9,252,188,231,207,123,207,89,239,125,247,152,163,154,186,198,135,95,220,
+180,119,117,123,166,157,109,117,175,22,224,220,130,13,140,133,112,227,232,35,
+176,13,50,124,42,67,69,70,61,57,114,92,236,66,173,121,193,158,222,96,
+59,114,233,98,161,94,190,4,164,152,238,100,50,127,175,58,66,218,187,26,
+170,204,31,161,137,159,151,249,99,102,78,142,65,110,43,90,172,194,251,82,
+174,11,10,128,124,101,240,198,40,30,215,82,74,192,21,138,168,75,141,253,
+133,102,236,157,50,94,229,172,249,88,189,237,74,255,31,24,185,132,73,67,
+46,162,200,131,152,35,183,48,120,206,42,104,104,32,62,198,87,124,74,126,
+112,169,51,234,165,134,237,29,163,215,244,0,230,24,234,220,211,47,79,76,
+109,249,100,190,136,237,216,45,55,212,68,78,19,171,196,19,215,32,108,67,
+222,132,39,193,7,223,245,244,50,35,101,151,230,159,9,170,208,42,215,170,
+143,149,135,117,207,202,19,236,12,73,156,178,156,201,207,198,11,206,97,77,
+211,149,152,116,18,1,233,151,105,182,25,148,200,83,59,140,150,140,220,77,
+181,3,25,249,94,2,5,141,213,201,7,189,47,128,236,141,244,38,193,38,
+176,27,15,194,4,104,254,182,25,155,190,109,6,57,226,131,33,72,215,138,
+12,80,237,156,6,73,21,151,194,106,82,177,213,224,238,180,133,186,145,85,
+81,45,170,169,165,113,33,39,233,149,219,226,93,169,185,163,226,77,37,21,
+145,238,126,94,41,192,78,129,133,96,62,77,186,103,62,41,89,79,2,161,
+188,97,140,24,104,145,239,218,129,186,20,63,174,91,6,115,149,21,183,127,
+96,11,162,157,17,11,138,149,252,252,99,116,109,189,8,150,73,100,71,233,
+43,246,162,39,125,14,120,136,87,44,52,144,157,144,190,94,148,157,177,111,
+105,140,248,172,217,45,22,43,46,228,188,199,42,64,102,172,247,243,169,21,
+92,170,173,27,165,159,91,138,15,220,221,168,210,232,49,67,201,76,244,179,
+77,213,180,64,26,126,50,207,216,33,123,213,213,123,218,241,193,211,80,170,
+183,177,207,154,118,49,234,100,156,188,181,17,141,79,72,147,244,77,207,227,
+239,198,122,54,103,101,198,140,182,113,75,181,84,237,99,73,73,214,129,20,
+221,214,10,28,218,149,209,68,68,191,114,158,204,183,70,55,149,235,38,82,
+249,209,77,62,227,180,149,231,238,200,149,50,154,239,145,215,123,128,237,112,
+60,72,4,17,88,88,166,55,17,88,156,39,27,166,37,47,24,127,188,219,
+21,104,209,72,222,212,123,74,171,147,218,131,54,37,0,179,41,69,9,243,
+102,32,139,60,18,106,55,212,182,202,245,122,111,253,85,226,138,141,99,216,
+84,85,194,254,170,14,168,82,136,27,26,148,108,149,71,41,241,152,172,125,
+214,150,50,21,127,252,95,222,19,53,68,237,102,23,43,35,123,198,143,73,
+60,62,166,60,107,107,172,138,232,249,55,19,14,207,194,221,66,77,61,93,
+211,165,132,67,232,246,142,38,13,149,80,98,15,55,145,200,49,135,184,7,
+86,91,244,119,234,68,56,215,92,144,106,127,216,30,8,145,80,242,5,181,
+116,120,222,97,109,168,92,135,10,148,184,147,138,62,165,68,57,26,68,60,
+27,243,49,18,27,254,44,49,30,126,121,196,196,218,107,14,196,239,199,227,
+243,223,5,31,34,98,56,123,71,145,163,52,58,107,139,180,246,60,250,93,
+30,246,74,221,234,178,236,63,232,117,251,125,9,52,210,46,193,155,245,68,
+134,197,65,100,59,64,199,41,69,165,155,56,40,93,61,154,224,29,73,87,
+154,84,182,155,41,175,26,168,122,138,158,146,203,210,246,118,131,220,28,93,
+106,195,39,175,41,135,170,42,253,100,172,173,35,221,253,184,201,53,229,53,
+237,34,125,216,101,146,156,113,54,25,26,181,80,142,18,155,17,219,20,109,
+91,124,44,131,129,242,7,160,55,102,189,15,167,201,5,213,167,41,198,167,
+67,9,138,13,129,184,216,152,23,213,222,213,203,210,143,10,251,190,20,226,
+228,71,172,200,202,178,212,32,227,159,242,28,219,166,179,185,194,223,199,18,
+240,90,167,59,157,75,126,32,71,9,97,27,111,24,142,182,71,195,7,126,
+228,131,25,214,44,144,99,122,249,45,114,239,134,217,203,131,16,228,88,234,
+157,173,228,34,187,156,123,198,76,52,133,174,83,44,42,130,173,214,105,209,
+171,5,248,179,128,215,207,226,167,116,98,151,229,13,108,247,249,122,205,177,
+37,207,8,21,97,39,204,192,47,207,184,7,52,64,179,210,136,57,52,35,
+102,241,202,195,58,53,155,0,224,18,15,80,104,121,130,225,1,129,106,15,
+53,10,212,93,240,132,122,100,129,209,9,25,242,27,22,26,117,153,136,241,
+24,75,184,54,127,145,80,54,123,25,198,196,149,106,183,216,33,47,65,50,
+222,163,30,28,253,69,117,76,12,208,42,35,113,67,166,11,61,69,175,29,
+232,88,47,40,118,241,197,73,242,66,162,22,95,16,25,120,65,145,139,47,
+164,3,165,8,16,189,32,210,141,170,221,165,88,131,40,28,48,179,232,13,
+164,81,239,90,126,97,8,254,77,106,92,239,133,47,94,252,162,24,100,187,
+83,195,194,240,165,122,24,137,83,157,44,221,200,1,26,50,232,144,22,28,
+204,176,89,64,196,110,204,181,137,234,108,170,34,55,110,154,168,185,149,181,
+49,251,146,215,186,131,137,82,89,221,120,182,86,145,156,174,108,182,37,219,
+166,221,121,116,219,198,19,108,219,102,124,247,1,251,72,50,199,53,145,52,
+255,6,16,125,51,138,131,219,244,139,109,48,131,128,239,211,47,122,219,110,
+225,194,64,115,42,186,228,30,15,96,45,0,95,101,150,252,22,32,63,204,
+66,254,104,25,6,25,17,152,238,192,221,1,164,148,88,37,247,60,43,102,
+197,244,7,76,142,133,145,70,51,20,108,40,22,86,239,177,1,78,195,33,
+80,53,185,235,43,20,232,156,45,224,251,170,250,114,197,33,33,227,50,243,
+174,107,48,166,148,133,40,62,208,200,92,12,51,191,245,43,53,143,108,109,
+7,107,49,201,54,10,171,195,178,188,143,165,90,200,63,33,80,250,209,69,
+243,92,224,90,237,10,52,101,16,111,194,71,3,220,48,118,49,172,80,236,
+48,173,15,3,252,49,75,233,109,69,193,47,43,104,137,62,15,148,196,49,
+186,201,38,36,253,1,197,133,192,150,38,131,32,168,206,23,15,67,57,87,
+141,76,117,74,230,18,92,44,62,185,2,195,2,115,195,96,0,1,169,43,
+16,3,188,91,234,92,224,72,47,112,98,152,12,232,147,2,185,36,149,188,
+184,147,100,141,79,159,3,2,161,47,181,182,216,198,173,129,129,189,64,38,
+215,150,98,36,95,183,197,216,185,171,252,154,110,232,183,84,38,67,215,131,
+36,201,152,37,73,5,65,86,205,215,101,167,206,113,102,246,252,220,225,153,
+94,184,37,38,70,119,123,95,179,209,40,56,35,239,128,132,173,216,3,255,
+70,71,148,216,165,34,229,195,187,34,69,156,201,109,167,173,115,18,253,21,
+225,125,32,107,56,219,218,0,127,117,109,36,186,14,136,174,60,123,217,173,
+212,166,18,120,2,163,125,4,42,90,71,192,143,181,125,94,28,233,103,147,
+122,241,43,234,240,103,124,36,82,199,127,241,37,24,48,57,102,171,204,203,
+190,153,178,110,80,101,90,24,9,88,113,184,89,56,1,94,127,93,6,193,
+115,190,161,2,33,163,164,79,107,89,73,111,77,4,10,14,13,94,252,168,
+217,35,33,233,71,1,44,92,123,106,228,1,163,137,210,74,101,190,116,9,
+239,84,121,203,188,147,162,189,150,12,62,145,186,220,9,191,179,41,204,157,
+142,107,221,32,182,32,93,172,242,219,38,53,155,37,207,189,146,15,2,27,
+31,176,128,215,223,238,65,68,223,13,246,14,206,29,109,193,143,123,224,248,
+196,69,40,89,154,105,60,173,174,151,186,204,241,151,247,236,48,72,48,74,
+45,181,175,31,78,58,73,25,77,223,167,187,120,5,183,69,209,179,130,234,
+219,116,55,120,17,215,6,215,199,110,63,156,217,205,176,120,220,147,118,8,
+189,36,174,32,221,236,218,181,121,207,89,81,207,118,60,231,55,255,154,112,
+166,213,236,228,5,221,194,195,67,110,63,122,51,242,24,243,103,252,60,166,
+118,207,159,129,198,81,182,185,187,23,164,186,42,4,33,225,151,122,144,88,
+187,164,214,24,152,167,242,222,67,81,99,249,16,225,236,192,88,109,122,127,
+63,9,149,102,178,155,34,17,147,60,45,70,35,20,166,2,81,160,22,67,
+8,202,228,119,101,87,67,165,43,237,104,165,11,10,107,165,44,8,20,25,
+108,56,97,196,85,250,150,94,47,253,88,17,119,254,201,156,127,50,231,159,
+204,249,31,135,57,255,228,123,63,249,222,63,58,223,91,83,24,2,250,189,
+112,202,177,235,53,204,52,120,74,76,246,68,93,150,214,62,205,30,150,84,
+57,60,158,244,53,103,120,71,130,107,99,6,56,111,131,252,224,126,47,185,
+3,139,105,151,54,111,92,78,137,60,107,177,0,118,46,103,49,239,106,125,
+90,120,196,89,23,82,19,43,171,33,49,61,201,32,184,126,164,186,153,245,
+156,255,223,95,175,225,175,55,151,239,225,127,207,17,1,49,148,13,85,6,
+66,182,238,173,103,87,72,139,196,27,241,93,114,94,49,150,123,188,166,119,
+169,184,233,37,13,70,33,153,216,113,187,210,183,109,213,154,49,119,60,131,
+24,70,129,61,134,152,139,139,70,76,48,174,64,81,140,182,143,36,232,111,
+116,19,70,254,47,13,214,154,177,163,254,170,195,164,188,139,55,230,135,8,
+110,241,238,193,52,74,5,137,141,181,255,208,124,77,33,192,18,126,139,180,
+46,195,7,10,106,157,246,131,150,218,109,164,2,215,12,0,210,45,8,182,
+13,171,94,73,57,246,163,40,233,151,130,87,84,193,17,95,210,37,94,251,
+138,178,131,100,103,17,254,119,213,45,149,218,87,105,62,83,140,170,27,197,
+47,16,228,149,167,18,104,222,243,27,203,243,239,53,75,153,61,121,147,121,
+188,44,129,25,11,213,177,151,152,43,230,253,6,156,194,21,241,40,85,243,
+80,213,119,84,226,142,166,121,149,238,52,85,204,171,106,6,46,221,237,50,
+140,149,167,204,115,88,178,140,105,96,175,225,12,247,222,21,182,11,231,235,
+141,195,194,231,97,186,48,47,163,11,21,242,57,248,189,42,102,43,4,118,
+165,0,109,113,192,160,102,224,248,132,104,196,5,136,67,63,53,215,70,157,
+22,55,237,8,3,97,245,137,137,193,114,162,128,94,250,182,23,157,93,140,
+168,8,51,37,53,134,69,15,156,74,66,78,153,206,202,195,15,106,11,0,
+199,255,60,94,18,225,153,138,33,28,12,199,231,71,86,46,176,85,41,249,
+90,99,96,57,244,247,183,219,127,117,1,53,248,180,182,193,46,25,213,53,
+8,30,177,232,170,84,72,239,215,160,8,184,140,202,178,162,2,48,209,103,
+32,166,43,21,244,161,68,87,22,101,103,218,84,189,44,188,245,134,99,8,
+109,45,34,241,154,6,112,135,103,135,101,48,5,111,35,239,79,84,138,234,
+48,111,216,113,24,117,16,248,235,29,119,175,58,26,102,37,147,62,109,155,
+164,101,226,109,182,21,34,82,156,107,73,77,225,222,230,144,53,198,246,13,
+8,255,21,23,241,172,39,40,246,73,87,19,113,88,73,80,250,127,128,211,
+158,165,211,210,22,246,53,87,167,201,175,228,66,167,167,59,52,122,114,202,
+53,61,210,33,133,14,93,73,237,6,62,153,70,103,242,234,199,70,83,61,
+141,28,37,142,49,50,175,23,84,136,253,100,37,102,139,195,101,191,8,88,
+230,197,254,69,226,15,236,79,61,70,108,19,143,162,2,46,200,69,103,182,
+78,234,28,197,152,119,247,125,232,2,65,168,166,166,113,10,17,213,16,207,
+249,161,83,138,5,220,249,149,87,253,122,89,118,173,184,173,192,188,230,93,
+220,93,65,190,57,26,231,78,10,54,57,20,15,115,5,93,175,199,4,234,
+249,170,99,44,232,226,146,248,182,99,160,4,246,218,234,255,230,180,109,47,
+1,76,178,18,104,74,110,128,178,202,54,173,239,216,144,159,87,232,37,180,
+63,70,253,181,31,117,118,183,64,229,184,242,154,95,32,159,253,250,152,67,
+125,93,138,7,180,51,114,88,56,146,6,1,177,55,216,191,125,75,111,222,
+248,149,161,27,181,232,137,51,119,219,191,198,142,166,144,252,157,157,119,213,
+141,115,205,194,104,72,137,136,219,85,112,104,131,59,71,38,199,143,218,15,
+27,26,41,27,197,144,72,41,212,186,233,106,230,34,59,221,234,172,174,64,
+254,170,202,30,230,1,125,59,112,116,138,132,88,52,182,92,194,3,94,108,
+27,94,169,190,49,218,248,183,27,175,177,80,190,94,121,225,55,170,104,210,
+231,156,25,55,201,121,210,145,247,52,15,204,126,126,3,77,8,4,0,11,
+82,127,63,248,238,209,97,231,8,19,219,2,138,148,42,252,8,47,182,168,
+225,206,58,196,232,254,45,26,162,246,130,60,48,103,80,77,253,112,57,1,
+58,109,128,212,172,90,17,15,210,36,131,235,128,250,77,239,186,77,87,55,
+155,231,48,55,54,241,164,147,56,227,82,100,19,210,151,177,241,62,204,44,
+196,171,16,135,115,6,187,122,134,169,185,32,7,80,196,203,2,125,138,91,
+147,233,150,93,55,118,100,201,71,31,85,176,240,76,185,50,205,252,130,252,
+36,157,32,87,71,156,8,46,120,150,146,208,108,178,121,112,153,191,205,84,
+48,112,79,204,31,225,217,3,169,222,61,85,214,189,126,208,122,105,122,193,
+30,206,212,161,179,146,132,61,140,71,157,90,164,168,235,248,225,29,84,58,
+54,86,46,118,16,193,89,219,0,171,57,107,93,128,158,95,71,110,18,143,
+134,54,6,12,97,14,210,188,201,240,159,249,27,48,187,191,12,252,115,237,
+174,53,254,62,99,125,192,33,206,234,195,253,143,195,65,216,21,89,99,212,
+94,180,138,239,130,227,26,160,230,215,49,49,216,88,43,98,87,209,208,186,
+27,173,94,179,236,212,166,53,221,136,94,217,203,238,69,138,9,251,115,33,
+44,109,84,93,211,93,131,57,114,140,33,255,50,172,23,116,54,16,16,70,
+3,131,207,174,62,89,94,88,15,71,58,77,222,75,176,175,20,97,150,130,
+0,94,47,170,1,88,213,185,19,130,134,153,168,117,19,126,168,118,71,209,
+80,254,238,81,135,80,208,139,100,240,227,140,248,204,152,149,40,131,167,2,
+104,202,43,0,75,27,229,93,173,113,123,126,79,29,90,234,12,19,82,139,
+207,22,183,104,37,97,189,134,136,45,74,43,251,10,227,31,53,114,201,228,
+5,33,152,202,95,32,210,191,64,85,193,126,24,15,41,70,99,3,46,129,
+75,173,90,12,61,77,134,68,96,80,201,160,59,41,23,199,16,29,204,42,
+38,186,196,103,18,11,133,105,112,231,94,15,182,117,212,45,229,66,118,218,
+13,15,194,37,179,12,189,255,25,178,26,216,226,5,190,185,106,55,60,163,
+168,25,102,108,35,248,103,182,180,200,203,174,0,169,194,112,78,116,11,244,
+249,31,227,41,107,240,146,23,38,77,6,107,155,133,190,73,239,212,16,250,
+167,212,35,8,25,193,215,121,202,79,138,180,36,104,107,83,21,35,101,31,
+45,146,102,75,6,56,153,57,212,228,42,138,69,165,82,57,249,33,169,190,
+154,163,2,179,79,110,55,191,128,70,115,190,6,96,154,223,211,46,178,2,
+18,54,29,92,180,36,167,26,57,201,109,90,175,176,149,77,64,24,13,217,
+139,90,255,196,194,38,132,242,134,119,126,156,175,12,159,198,152,116,208,186,
+138,191,243,149,127,48,57,133,97,57,21,162,124,220,215,47,154,66,29,108,
+104,177,198,58,234,109,19,5,48,242,177,116,143,236,72,209,161,193,212,145,
+162,102,101,211,217,38,173,2,136,84,33,231,234,28,198,162,174,164,129,14,
+70,29,22,242,9,247,255,173,46,181,217,252,40,7,112,94,230,189,51,24,
+101,176,127,215,115,234,217,130,127,85,233,110,129,61,248,243,248,35,31,158,
+97,24,7,187,41,211,157,217,84,141,247,8,250,180,184,138,157,18,35,189,
+108,154,167,21,123,89,108,23,65,201,131,117,145,237,217,246,75,104,138,229,
+150,104,100,87,182,76,230,35,76,209,223,192,136,108,84,177,190,1,126,57,
+107,196,122,93,120,5,203,160,3,37,126,236,27,41,143,99,109,222,137,43,
+81,151,88,43,240,161,166,97,203,2,70,142,230,235,184,105,56,180,102,70,
+6,120,186,101,115,163,82,255,9,225,49,24,63,63,77,197,32,91,150,36,
+154,225,216,140,241,227,185,69,148,148,230,29,208,188,8,220,147,179,171,221,
+33,211,177,63,12,22,124,139,89,172,143,174,14,149,188,224,129,252,187,109,
+7,125,97,171,167,218,180,182,206,131,201,53,115,220,181,198,138,152,100,183,
+71,81,174,236,162,22,108,162,30,179,3,91,89,231,115,79,246,243,231,254,
+71,92,239,224,61,65,18,62,254,204,178,72,175,230,9,31,235,47,251,238,
+136,47,242,153,119,208,124,19,67,148,4,255,56,47,67,63,99,86,249,121,
+36,125,220,223,229,52,207,47,236,59,116,221,102,142,110,229,38,220,239,169,
+237,92,200,193,108,253,2,202,120,227,250,149,158,15,253,159,190,12,74,78,
+76,229,187,90,231,46,109,239,90,57,239,60,251,252,130,103,115,239,117,138,
+163,31,27,165,134,15,74,35,27,216,162,170,106,203,42,65,75,103,6,122,
+217,47,192,243,72,36,140,157,223,162,192,123,91,228,129,203,241,224,145,120,
+219,57,85,150,103,19,63,167,67,78,177,203,227,220,196,206,19,180,89,64,
+179,29,86,66,230,212,70,78,119,37,209,171,166,117,6,178,203,192,66,98,
+185,208,120,230,194,208,94,213,231,245,51,225,107,162,1,177,171,32,176,79,
+145,8,128,25,151,218,208,67,172,218,176,23,65,234,126,210,197,181,2,130,
+115,1,177,98,37,201,216,146,211,14,141,255,215,191,252,239,127,253,63,50,
+226,209,128,67,121,203,92,98,115,138,179,255,17,251,147,51,152,209,1,249,
+214,168,168,182,6,4,192,63,248,179,77,91,222,141,27,166,228,215,158,186,
+240,57,12,196,83,141,0,105,194,8,189,49,134,49,58,93,94,197,220,73,
+62,219,171,154,152,69,210,55,222,118,234,207,33,98,4,230,56,220,40,85,
+142,223,131,181,127,241,186,92,250,46,34,197,234,109,13,5,1,75,234,113,
+173,110,177,192,215,94,66,139,82,167,166,119,15,103,80,122,133,81,221,139,
+161,154,75,28,244,174,150,123,9,213,190,153,206,79,60,111,172,43,192,187,
+163,26,235,211,211,176,28,255,77,16,81,58,186,80,57,162,11,32,195,155,
+79,187,28,109,134,61,254,205,229,99,216,118,151,146,162,218,223,30,238,49,
+254,18,105,100,59,39,14,213,123,3,54,188,219,193,17,245,128,126,174,19,
+66,163,8,30,78,210,242,94,224,145,248,123,181,6,234,65,239,232,78,86,
+18,235,128,122,172,163,217,15,119,128,107,134,246,25,160,53,231,105,182,177,
+127,218,151,162,201,153,107,193,242,29,205,50,182,13,44,176,77,224,123,174,
+190,156,176,207,129,172,241,126,203,52,161,75,213,249,231,236,254,89,202,103,
+135,225,1,154,141,174,163,253,73,175,10,24,214,112,8,209,180,63,127,253,
+255,4,139,81,214
\ No newline at end of file